@@ -0,0 +1,79 @@
+#include "alloc_counter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<uint64_t> s_Allocations{0};
+std::atomic<uint64_t> s_Bytes{0};
+std::atomic<int64_t> s_Live{0};
+std::atomic<int64_t> s_Peak{0};
+
+// Each block carries its size in a header so frees can be accounted
+const size_t kHeader = alignof(std::max_align_t);
+
+void *CountedAlloc(size_t size) {
+  void *raw = std::malloc(size + kHeader);
+  if (!raw)
+    return nullptr;
+  *static_cast<size_t *>(raw) = size;
+  s_Allocations++;
+  s_Bytes += size;
+  int64_t live = s_Live += static_cast<int64_t>(size);
+  int64_t peak = s_Peak.load();
+  while (live > peak && !s_Peak.compare_exchange_weak(peak, live)) {
+  }
+  return static_cast<char *>(raw) + kHeader;
+}
+
+void CountedFree(void *ptr) {
+  if (!ptr)
+    return;
+  void *raw = static_cast<char *>(ptr) - kHeader;
+  s_Live -= static_cast<int64_t>(*static_cast<size_t *>(raw));
+  std::free(raw);
+}
+
+} // namespace
+
+namespace AllocCounter {
+
+uint64_t Allocations() { return s_Allocations.load(); }
+uint64_t BytesAllocated() { return s_Bytes.load(); }
+uint64_t PeakBytes() { return static_cast<uint64_t>(s_Peak.load()); }
+void ResetPeak() { s_Peak = s_Live.load(); }
+
+void *ImGuiAlloc(size_t size, void *) { return CountedAlloc(size); }
+void ImGuiFree(void *ptr, void *) { CountedFree(ptr); }
+
+} // namespace AllocCounter
+
+void *operator new(size_t size) {
+  void *p = CountedAlloc(size ? size : 1);
+  if (!p)
+    throw std::bad_alloc();
+  return p;
+}
+
+void *operator new[](size_t size) { return operator new(size); }
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+  return CountedAlloc(size ? size : 1);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept {
+  return CountedAlloc(size ? size : 1);
+}
+
+void operator delete(void *ptr) noexcept { CountedFree(ptr); }
+void operator delete[](void *ptr) noexcept { CountedFree(ptr); }
+void operator delete(void *ptr, size_t) noexcept { CountedFree(ptr); }
+void operator delete[](void *ptr, size_t) noexcept { CountedFree(ptr); }
+void operator delete(void *ptr, const std::nothrow_t &) noexcept {
+  CountedFree(ptr);
+}
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept {
+  CountedFree(ptr);
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Global allocation accounting for the benchmarks. Counts every operator
+// new and every ImGui allocation routed through the counting allocator.
+namespace AllocCounter {
+
+uint64_t Allocations();
+uint64_t BytesAllocated();
+// Largest number of bytes live at once since the last ResetPeak()
+uint64_t PeakBytes();
+void ResetPeak();
+
+void *ImGuiAlloc(size_t size, void *userData);
+void ImGuiFree(void *ptr, void *userData);
+
+} // namespace AllocCounter
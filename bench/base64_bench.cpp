@@ -0,0 +1,54 @@
+// Base64 throughput on MB-sized random input, SSE4.1 path against the
+// scalar one, plus the caller-buffer API that skips the std::string.
+//
+//   tc_base64_bench [megabytes]
+
+#include "bench_util.h"
+
+#include "base64.h"
+
+#include <cstdlib>
+
+static void PrintThroughput(const BenchUtil::Result &r, size_t bytes) {
+  BenchUtil::Print(r);
+  double p50 = BenchUtil::Percentile(r.Micros, 0.50);
+  printf("  %.0f MB/s\n", p50 > 0 ? bytes / p50 : 0.0);
+}
+
+int main(int argc, char **argv) {
+  double megabytes = argc > 1 ? std::atof(argv[1]) : 4.0;
+  size_t size = static_cast<size_t>(megabytes * 1024 * 1024);
+
+  BenchUtil::Lcg rng(42);
+  std::string raw(size, '\0');
+  for (auto &c : raw)
+    c = static_cast<char>(rng.Next());
+  std::string text = Base64::Encode(raw);
+  std::string buffer(Base64::EncodedSize(size), '\0');
+
+  BenchUtil::PrintHeader();
+  for (bool simd : {false, true}) {
+    Base64::SetSimdEnabled(simd);
+    std::string path = simd ? " (SIMD)" : " (scalar)";
+    PrintThroughput(BenchUtil::Run("Base64::Encode" + path, 20,
+                                   [&] { Base64::Encode(raw); }),
+                    size);
+    PrintThroughput(BenchUtil::Run("Base64::Decode" + path, 20,
+                                   [&] { Base64::Decode(text); }),
+                    size);
+    PrintThroughput(BenchUtil::Run("Base64::Encode into buffer" + path, 20,
+                                   [&] { Base64::Encode(raw, &buffer[0]); }),
+                    size);
+    PrintThroughput(BenchUtil::Run("Base64::Decode into buffer" + path, 20,
+                                   [&] { Base64::Decode(text, &buffer[0]); }),
+                    size);
+    if (Base64::Decode(text) != raw) {
+      printf("round trip FAILED%s\n", path.c_str());
+      return 1;
+    }
+  }
+  Base64::SetSimdEnabled(true);
+
+  printf("\n%.1f MB input, %zu characters encoded\n", megabytes, text.size());
+  return 0;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "alloc_counter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <string>
+#include <vector>
+
+// Small timing helpers shared by the benchmark executables.
+namespace BenchUtil {
+
+inline double ThreadCpuMicros() {
+  timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+inline double WallMicros() {
+  return std::chrono::duration<double, std::micro>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+inline double Percentile(std::vector<double> samples, double q) {
+  if (samples.empty())
+    return 0.0;
+  std::sort(samples.begin(), samples.end());
+  size_t idx = static_cast<size_t>(q * (samples.size() - 1) + 0.5);
+  return samples[idx];
+}
+
+inline double Mean(const std::vector<double> &samples) {
+  if (samples.empty())
+    return 0.0;
+  double sum = 0.0;
+  for (double s : samples)
+    sum += s;
+  return sum / samples.size();
+}
+
+struct Result {
+  std::string Name;
+  std::vector<double> Micros; // Wall time per iteration
+  uint64_t Allocations = 0;   // Summed over all iterations
+};
+
+// Runs fn `iterations` times, timing each call
+template <typename Fn> Result Run(const std::string &name, int iterations, Fn &&fn) {
+  Result result;
+  result.Name = name;
+  uint64_t allocsBefore = AllocCounter::Allocations();
+  for (int i = 0; i < iterations; ++i) {
+    double start = WallMicros();
+    fn();
+    result.Micros.push_back(WallMicros() - start);
+  }
+  result.Allocations = AllocCounter::Allocations() - allocsBefore;
+  return result;
+}
+
+inline void PrintHeader() {
+  printf("%-40s %8s %12s %12s %12s %12s\n", "benchmark", "iters", "mean us",
+         "p50 us", "p95 us", "allocs/iter");
+}
+
+inline void Print(const Result &r) {
+  printf("%-40s %8zu %12.1f %12.1f %12.1f %12.1f\n", r.Name.c_str(),
+         r.Micros.size(), Mean(r.Micros), Percentile(r.Micros, 0.50),
+         Percentile(r.Micros, 0.95),
+         r.Micros.empty() ? 0.0
+                          : static_cast<double>(r.Allocations) / r.Micros.size());
+}
+
+// Deterministic generator so every run benchmarks the same data
+class Lcg {
+public:
+  explicit Lcg(uint32_t seed) : m_State(seed) {}
+  uint32_t Next() {
+    m_State = m_State * 1664525u + 1013904223u;
+    return m_State >> 8;
+  }
+  int Range(int lo, int hi) { return lo + static_cast<int>(Next() % (hi - lo + 1)); }
+
+private:
+  uint32_t m_State;
+};
+
+} // namespace BenchUtil
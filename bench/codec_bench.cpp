@@ -0,0 +1,185 @@
+// Times encode/decode of every TrainCodec backend and a full library
+// save/load per storage format. Round-trip correctness is checked by
+// tests/train_codec_test.cpp.
+//
+//   tc_codec_bench [trains] [steps]
+
+#include "bench_util.h"
+#include "synthetic.h"
+
+#include "base64.h"
+#include "platform.h"
+#include "train_codec.h"
+#include "train_manager.h"
+#include "train_reader.h"
+#include "train_schema.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+
+namespace {
+
+struct Backend {
+  const char *Name;
+  std::function<std::string(const TrainTemplate &)> Encode;
+  std::function<bool(const std::string &, TrainTemplate &)> Decode;
+};
+
+std::vector<Backend> Backends() {
+  auto domDecode = [](const std::string &text, TrainTemplate &out) {
+    try {
+      TrainCodec::FromJson(TrainCodec::json::parse(text), out);
+      return true;
+    } catch (...) {
+      return false;
+    }
+  };
+  auto shareDecode = [](const std::string &text, TrainTemplate &out) {
+    return TrainCodec::FromShareString(text, out);
+  };
+  auto format = [](const char *name, TrainFormat format) {
+    return Backend{
+        name,
+        [format](const TrainTemplate &t) { return TrainCodec::Encode(t, format); },
+        [format](const std::string &data, TrainTemplate &out) {
+          return TrainCodec::Decode(data, format, out);
+        }};
+  };
+  return {
+      {"pretty JSON (DOM)",
+       [](const TrainTemplate &t) { return TrainCodec::ToJsonText(t, true); },
+       domDecode},
+      format("pretty JSON (SAX)", TrainFormat::PrettyJson),
+      format("compact JSON (SAX)", TrainFormat::CompactJson),
+      format("CBOR (SAX)", TrainFormat::Cbor),
+      format("MessagePack (SAX)", TrainFormat::MsgPack),
+      {"binary", TrainCodec::ToBinary, TrainCodec::FromBinary},
+      {"share string", TrainCodec::ToShareString, shareDecode},
+      {"share string (legacy)",
+       [](const TrainTemplate &t) {
+         return Base64::Encode(TrainCodec::ToJsonText(t, false));
+       },
+       shareDecode},
+  };
+}
+
+// One long train with little repetition between steps; the synthetic
+// library repeats the same sentences and flatters any compressor
+TrainTemplate VariedTrain(int stepCount) {
+  static const char *kWords[] = {
+      "pull",   "left",   "right", "stack",  "dodge",  "break",  "bar",
+      "cleave", "ranged", "melee", "kite",   "portal", "wall",   "south",
+      "north",  "tag",    "adds",  "boss",   "phase",  "timer",  "ooze",
+      "bubble", "reflect", "mortar", "golem", "waypoint", "meet", "spread",
+      "push",   "burn",   "chest", "bounty", "swim",   "glider", "mount"};
+  const size_t wordCount = sizeof(kWords) / sizeof(kWords[0]);
+  uint32_t seed = 12345;
+  auto next = [&] { return seed = seed * 1664525u + 1013904223u; };
+  auto sentence = [&](int words) {
+    std::string text;
+    for (int w = 0; w < words; ++w) {
+      if (w)
+        text += next() % 7 ? " " : ", ";
+      text += kWords[(next() >> 8) % wordCount];
+      if (next() % 5 == 0)
+        text += std::to_string(next() % 100);
+    }
+    return text + ".";
+  };
+
+  TrainTemplate train;
+  TrainSchema::ResetToDefaults(train);
+  train.Name = "Varied Train";
+  for (int s = 0; s < stepCount; ++s) {
+    TrainStep step;
+    TrainSchema::ResetToDefaults(step);
+    step.Title = sentence(3);
+    step.Description = sentence(12);
+    step.Mechanics = sentence(40);
+    step.SpawnMinuteUTC = static_cast<int>(next() % 1440);
+    step.DurationMinutes = static_cast<int>(next() % 30);
+    for (int m = 0; m < 3; ++m)
+      step.CustomMessages.push_back({sentence(2), sentence(15)});
+    train.Steps.push_back(step);
+  }
+  return train;
+}
+
+// Save then cold-load the whole library in each storage format
+void BenchStorage(const std::vector<TrainTemplate> &library) {
+  std::string dir =
+      (std::filesystem::temp_directory_path() / "tc_codec_bench").string();
+  for (TrainFormat format : {TrainFormat::PrettyJson, TrainFormat::Cbor,
+                             TrainFormat::MsgPack}) {
+    std::string name = TrainCodec::FormatName(format);
+    BenchUtil::Print(BenchUtil::Run("SaveTrains (" + name + ")", 5, [&] {
+      // From scratch, or the content-addressed shards would all be reused
+      std::filesystem::remove_all(dir);
+      Platform::EnsureDirectory(dir);
+      TrainManager writer(dir);
+      writer.SetStorageFormat(format);
+      writer.GetTrains() = library;
+      writer.MarkDirty();
+      writer.SaveTrains();
+    }));
+    bool intact = true;
+    BenchUtil::Print(BenchUtil::Run("LoadTrains + bodies (" + name + ")", 5, [&] {
+      TrainManager reader(dir);
+      reader.LoadTrains();
+      for (size_t i = 0; i < reader.GetTrains().size(); ++i) {
+        reader.EnsureLoaded(static_cast<int>(i));
+        intact = intact && reader.GetTrains()[i] == library[i];
+      }
+    }));
+
+    uintmax_t bytes = 0;
+    for (const auto &file : std::filesystem::directory_iterator(
+             std::filesystem::path(dir) / "trains"))
+      bytes += file.file_size();
+    printf("  %.2f MB on disk%s\n", bytes / (1024.0 * 1024.0),
+           intact ? "" : ", LIBRARY CHANGED ON RELOAD");
+  }
+  std::filesystem::remove_all(dir);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  int trainCount = argc > 1 ? std::atoi(argv[1]) : 200;
+  int stepCount = argc > 2 ? std::atoi(argv[2]) : 50;
+
+  std::vector<TrainTemplate> library = Synthetic::MakeTrains(trainCount, stepCount);
+
+  BenchUtil::PrintHeader();
+  for (const auto &backend : Backends()) {
+    std::vector<std::string> encoded(library.size());
+    BenchUtil::Print(BenchUtil::Run(std::string(backend.Name) + " encode", 5, [&] {
+      for (size_t i = 0; i < library.size(); ++i)
+        encoded[i] = backend.Encode(library[i]);
+    }));
+    BenchUtil::Print(BenchUtil::Run(std::string(backend.Name) + " decode", 5, [&] {
+      for (const auto &data : encoded) {
+        TrainTemplate train;
+        backend.Decode(data, train);
+      }
+    }));
+    size_t bytes = 0;
+    for (const auto &data : encoded)
+      bytes += data.size();
+    printf("  %.2f MB for %d trains x %d steps\n", bytes / (1024.0 * 1024.0),
+           trainCount, stepCount);
+  }
+
+  TrainTemplate varied = VariedTrain(stepCount);
+  printf("\nvaried %d-step train: compact JSON %zu bytes, share string %zu "
+         "bytes (legacy %zu)\n",
+         stepCount, TrainCodec::ToJsonText(varied, false).size(),
+         TrainCodec::ToShareString(varied).size(),
+         Base64::Encode(TrainCodec::ToJsonText(varied, false)).size());
+
+  printf("\n");
+  BenchUtil::PrintHeader();
+  BenchStorage(library);
+  return 0;
+}
@@ -0,0 +1,112 @@
+// Benchmarks for the platform-neutral core: catalog queries, library
+// save/load, share-string encoding, chat line splitting and callout timing.
+//
+//   tc_core_bench [trains] [steps]
+
+#include "bench_util.h"
+#include "synthetic.h"
+
+#include "base64.h"
+#include "callout_scheduler.h"
+#include "chat_splitter.h"
+#include "event_catalog.h"
+#include "frame_clock.h"
+#include "platform.h"
+#include "train_manager.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <thread>
+
+int main(int argc, char **argv) {
+  int trainCount = argc > 1 ? std::atoi(argv[1]) : 200;
+  int stepCount = argc > 2 ? std::atoi(argv[2]) : 50;
+
+  std::string dir =
+      (std::filesystem::temp_directory_path() / "tc_core_bench").string();
+  std::filesystem::remove_all(dir);
+  Platform::EnsureDirectory(dir);
+
+  BenchUtil::PrintHeader();
+
+  // Catalog queries over 5k events
+  EventCatalog catalog(dir);
+  while (catalog.IsFetching())
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  catalog.SetEvents(Synthetic::MakeCatalog());
+  FrameClock clock = FrameClock::FromEpochMilliseconds(1759262400000LL);
+
+  BenchUtil::Print(BenchUtil::Run("EventCatalog::GetEventsInRange", 200,
+                                  [&] { catalog.GetEventsInRange(clock, -15, 120); }));
+  BenchUtil::Print(BenchUtil::Run("EventCatalog::GetUpcomingEvents", 200,
+                                  [&] { catalog.GetUpcomingEvents(clock); }));
+
+  // Library persistence
+  TrainManager manager(dir);
+  manager.GetTrains() = Synthetic::MakeTrains(trainCount, stepCount);
+  BenchUtil::Print(
+      BenchUtil::Run("TrainManager::SaveTrains", 10, [&] { manager.SaveTrains(); }));
+  int edits = 0;
+  BenchUtil::Print(BenchUtil::Run("TrainManager::SaveTrains (one edit)", 10, [&] {
+    manager.GetTrains()[edits % trainCount].Steps[0].Title =
+        "Edited " + std::to_string(edits);
+    edits++;
+    manager.MarkDirty();
+    manager.SaveTrains();
+  }));
+
+  TrainManager loader(dir);
+  BenchUtil::Print(
+      BenchUtil::Run("TrainManager::LoadTrains", 10, [&] { loader.LoadTrains(); }));
+  int next = 0;
+  BenchUtil::Print(BenchUtil::Run("TrainManager::EnsureLoaded (cold)", 50, [&] {
+    loader.EnsureLoaded(next++ % trainCount);
+  }));
+
+  // Share strings
+  std::string shared;
+  BenchUtil::Print(BenchUtil::Run("TrainManager::ExportToClipboard", 50, [&] {
+    shared = manager.ExportToClipboard(0);
+  }));
+  BenchUtil::Print(BenchUtil::Run("Base64::Decode (share string)", 50,
+                                  [&] { Base64::Decode(shared); }));
+
+  // Chat lines for a long mechanics block, redone on every editor keypress
+  std::string mechanics;
+  for (int i = 0; i < 200; ++i)
+    mechanics += i % 8 == 0 ? "[&BDAEAAA=] " : i % 25 == 0 ? "Gruppe 3 → Süd\n"
+                                                            : "stack ";
+  std::vector<std::string_view> lines;
+  BenchUtil::Print(BenchUtil::Run("ChatSplitter::Split (1.5 KB)", 1000, [&] {
+    ChatSplitter::Split(mechanics, 196, lines);
+  }));
+
+  // Timed callouts: a frame advances the wheel by at most a second
+  TrainTemplate calloutTrain = Synthetic::MakeTrains(1, 100)[0];
+  for (size_t s = 0; s < calloutTrain.Steps.size(); ++s) {
+    TrainStep &step = calloutTrain.Steps[s];
+    step.SpawnMinuteUTC = static_cast<int>(s * 14 % 1440);
+    for (int offset : {-300, -60, 0, 30, 120})
+      step.Callouts.push_back({offset, CalloutContent::Message, 0});
+  }
+  CalloutScheduler callouts;
+  std::vector<CalloutScheduler::Due> due;
+  BenchUtil::Print(BenchUtil::Run("CalloutScheduler::Sync (500 callouts)", 50,
+                                  [&] {
+                                    callouts.Sync(nullptr, 0, clock);
+                                    callouts.Sync(&calloutTrain, 1, clock);
+                                  }));
+  int64_t frameMs = clock.EpochMilliseconds;
+  BenchUtil::Print(BenchUtil::Run("CalloutScheduler::Update (per frame)", 1000,
+                                  [&] {
+                                    frameMs += 16;
+                                    due.clear();
+                                    callouts.Update(
+                                        FrameClock::FromEpochMilliseconds(frameMs),
+                                        due);
+                                  }));
+
+  printf("\n%d trains x %d steps, share string %zu bytes\n", trainCount,
+         stepCount, shared.size());
+  return 0;
+}
@@ -0,0 +1,127 @@
+// Library deserialization: nlohmann DOM + field copies (the previous load
+// path) against the SAX TrainReader, on one large single-file library.
+//
+//   tc_parse_bench [megabytes]
+
+#include "bench_util.h"
+#include "synthetic.h"
+
+#include "nlohmann_json.hpp"
+#include "train_reader.h"
+
+#include <cstdlib>
+
+using json = nlohmann::json;
+
+// The DOM reader as TrainManager used it before TrainReader
+static std::vector<TrainTemplate> DomReadLibrary(const std::string &text) {
+  std::vector<TrainTemplate> trains;
+  json j = json::parse(text);
+  for (const auto &jTrain : j["trains"]) {
+    TrainTemplate train;
+    train.Name = jTrain.value("Name", "Unnamed Train");
+    train.Author = jTrain.value("Author", "Unknown");
+    train.Type = static_cast<TrainType>(jTrain.value("Type", 2));
+    for (const auto &jStep : jTrain["steps"]) {
+      TrainStep step;
+      step.Title = jStep.value("Title", "Step");
+      step.Description = jStep.value("Description", "");
+      step.WaypointCode = jStep.value("WaypointCode", "");
+      step.SquadMessage = jStep.value("SquadMessage", "");
+      step.Mechanics = jStep.value("Mechanics", "");
+      step.SpawnMinuteUTC = jStep.value("SpawnMinuteUTC", -1);
+      step.DurationMinutes = jStep.value("DurationMinutes", 0);
+      if (jStep.contains("CustomMessages") &&
+          jStep["CustomMessages"].is_array()) {
+        for (const auto &msgObj : jStep["CustomMessages"]) {
+          CustomMessage msg;
+          msg.title = msgObj.value("title", "");
+          msg.text = msgObj.value("text", "");
+          step.CustomMessages.push_back(msg);
+        }
+      }
+      train.Steps.push_back(step);
+    }
+    trains.push_back(train);
+  }
+  return trains;
+}
+
+static json TrainToJson(const TrainTemplate &train) {
+  json jTrain;
+  jTrain["Name"] = train.Name;
+  jTrain["Author"] = train.Author;
+  jTrain["Type"] = static_cast<int>(train.Type);
+  jTrain["steps"] = json::array();
+  for (const auto &step : train.Steps) {
+    json jStep;
+    jStep["Title"] = step.Title;
+    jStep["Description"] = step.Description;
+    jStep["WaypointCode"] = step.WaypointCode;
+    jStep["SquadMessage"] = step.SquadMessage;
+    jStep["Mechanics"] = step.Mechanics;
+    jStep["SpawnMinuteUTC"] = step.SpawnMinuteUTC;
+    jStep["DurationMinutes"] = step.DurationMinutes;
+    jStep["CustomMessages"] = json::array();
+    for (const auto &msg : step.CustomMessages)
+      jStep["CustomMessages"].push_back({{"title", msg.title}, {"text", msg.text}});
+    jTrain["steps"].push_back(jStep);
+  }
+  return jTrain;
+}
+
+// Peak live heap above the level at entry while fn runs
+template <typename Fn> static uint64_t PeakBytes(Fn &&fn) {
+  AllocCounter::ResetPeak();
+  uint64_t base = AllocCounter::PeakBytes();
+  fn();
+  return AllocCounter::PeakBytes() - base;
+}
+
+int main(int argc, char **argv) {
+  size_t megabytes = argc > 1 ? std::atoi(argv[1]) : 50;
+  const int stepsPerTrain = 50;
+
+  // Grow the library until its pretty-printed form reaches the target size
+  std::string text;
+  {
+    // Sample at library nesting depth; indentation adds up
+    json sample = {{"trains", json::array()}};
+    for (const auto &train : Synthetic::MakeTrains(16, stepsPerTrain))
+      sample["trains"].push_back(TrainToJson(train));
+    size_t trainBytes = sample.dump(4).size() / 16;
+    int trainCount =
+        static_cast<int>(megabytes * 1024 * 1024 / trainBytes) + 1;
+    json j;
+    j["generation"] = 1;
+    j["trains"] = json::array();
+    for (const auto &train : Synthetic::MakeTrains(trainCount, stepsPerTrain))
+      j["trains"].push_back(TrainToJson(train));
+    text = j.dump(4);
+  }
+
+  std::vector<TrainTemplate> dom, sax;
+  uint64_t generation = 0;
+  uint64_t domPeak = PeakBytes([&] { dom = DomReadLibrary(text); });
+  uint64_t saxPeak =
+      PeakBytes([&] { TrainReader::ReadLibrary(text, sax, generation); });
+  if (dom != sax) {
+    printf("mismatch between DOM and SAX results\n");
+    return 1;
+  }
+
+  BenchUtil::PrintHeader();
+  BenchUtil::Print(BenchUtil::Run("DOM parse + copy", 5, [&] {
+    dom = DomReadLibrary(text);
+  }));
+  BenchUtil::Print(BenchUtil::Run("TrainReader::ReadLibrary (SAX)", 5, [&] {
+    TrainReader::ReadLibrary(text, sax, generation);
+  }));
+
+  // The results themselves are included in both peaks
+  printf("\n%.1f MB library, %zu trains x %d steps\n",
+         text.size() / (1024.0 * 1024.0), sax.size(), stepsPerTrain);
+  printf("peak heap: DOM %.1f MB, SAX %.1f MB\n", domPeak / (1024.0 * 1024.0),
+         saxPeak / (1024.0 * 1024.0));
+  return 0;
+}
@@ -0,0 +1,59 @@
+#include "synthetic.h"
+#include "bench_util.h"
+
+#include <string>
+
+namespace Synthetic {
+
+std::vector<EventDefinition> MakeCatalog(int categories,
+                                         int eventsPerCategory) {
+  BenchUtil::Lcg rng(1234);
+  std::vector<EventDefinition> events;
+  events.reserve(categories * eventsPerCategory);
+  for (int c = 0; c < categories; ++c) {
+    std::string category = "Category " + std::to_string(c);
+    for (int e = 0; e < eventsPerCategory; ++e) {
+      EventDefinition def;
+      def.Name = "Synthetic Event " + std::to_string(c) + "-" +
+                 std::to_string(e) + " of the Long Name";
+      def.Map = category;
+      def.WaypointCode = "[&BNABAAA=]";
+      int interval = rng.Range(60, 240);
+      int offset = rng.Range(0, interval - 1);
+      for (int m = offset; m < 1440; m += interval) {
+        def.SpawnTimesUTC.push_back(m);
+        def.DurationsUTC.push_back(rng.Range(5, 30));
+      }
+      events.push_back(def);
+    }
+  }
+  return events;
+}
+
+std::vector<TrainTemplate> MakeTrains(int trainCount, int stepsPerTrain) {
+  BenchUtil::Lcg rng(42);
+  std::vector<TrainTemplate> trains;
+  for (int t = 0; t < trainCount; ++t) {
+    TrainTemplate train;
+    train.Name = "Synthetic Train " + std::to_string(t);
+    train.Author = "Bench";
+    for (int s = 0; s < stepsPerTrain; ++s) {
+      TrainStep step;
+      step.Title = "Step " + std::to_string(s);
+      step.Description = "Synthetic step description for benchmarking.";
+      step.WaypointCode = "[&BNABAAA=]";
+      step.SquadMessage = "Next up: Step " + std::to_string(s + 1);
+      step.Mechanics = "Group 1 left, group 2 right, stack on tag for CC.";
+      step.SpawnMinuteUTC = rng.Range(0, 1439);
+      step.DurationMinutes = rng.Range(5, 20);
+      for (int m = 0; m < 3; ++m)
+        step.CustomMessages.push_back(
+            {"Message " + std::to_string(m), "Custom callout text"});
+      train.Steps.push_back(step);
+    }
+    trains.push_back(train);
+  }
+  return trains;
+}
+
+} // namespace Synthetic
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "event_catalog.h"
+#include "train_types.h"
+#include <vector>
+
+// Deterministic synthetic data shared by the benchmarks
+namespace Synthetic {
+
+// `categories` x `eventsPerCategory` events with recurring daily spawns
+std::vector<EventDefinition> MakeCatalog(int categories = 100,
+                                         int eventsPerCategory = 50);
+
+// Trains whose steps carry realistic text in every field
+std::vector<TrainTemplate> MakeTrains(int trainCount, int stepsPerTrain);
+
+} // namespace Synthetic
@@ -0,0 +1,145 @@
+// Headless benchmark for the addon windows. Renders EditorUI, OverlayUI and
+// EventUI into an ImGui context without a renderer backend, fed with a
+// synthetic catalog and train library, and reports per-window CPU time and
+// allocations per frame.
+//
+//   tc_ui_bench [frames]
+
+#include "alloc_counter.h"
+#include "bench_util.h"
+#include "synthetic.h"
+
+#include "editor_ui.h"
+#include "event_catalog.h"
+#include "event_ui.h"
+#include "frame_clock.h"
+#include "imgui/imgui.h"
+#include "overlay_ui.h"
+#include "train_manager.h"
+
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+Texture_t s_Icon = {64, 64, reinterpret_cast<void *>(1)};
+
+Texture_t *StubTexturesGet(const char *) { return &s_Icon; }
+Texture_t *StubTexturesFromMemory(const char *, void *, uint64_t) {
+  return &s_Icon;
+}
+void StubLog(ELogLevel, const char *, const char *) {}
+void StubAlert(const char *) {}
+void StubGameBind(EGameBinds) {}
+void StubGameBindAsync(EGameBinds, int32_t) {}
+LRESULT StubSendToGame(HWND, UINT, WPARAM, LPARAM) { return 0; }
+
+AddonAPI_t MakeStubApi() {
+  AddonAPI_t api = {};
+  api.Log = StubLog;
+  api.GUI_SendAlert = StubAlert;
+  api.Textures_Get = StubTexturesGet;
+  api.Textures_GetOrCreateFromMemory = StubTexturesFromMemory;
+  api.GameBinds_Press = StubGameBind;
+  api.GameBinds_Release = StubGameBind;
+  api.GameBinds_InvokeAsync = StubGameBindAsync;
+  api.WndProc_SendToGameOnly = StubSendToGame;
+  return api;
+}
+
+struct WindowStats {
+  explicit WindowStats(const char *name) : Name(name) {}
+
+  const char *Name = nullptr;
+  std::vector<double> CpuMicros;
+  uint64_t Allocations = 0;
+};
+
+template <typename Fn> void Measure(WindowStats &stats, Fn &&fn) {
+  uint64_t allocsBefore = AllocCounter::Allocations();
+  double cpuBefore = BenchUtil::ThreadCpuMicros();
+  fn();
+  stats.CpuMicros.push_back(BenchUtil::ThreadCpuMicros() - cpuBefore);
+  stats.Allocations += AllocCounter::Allocations() - allocsBefore;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  int frames = argc > 1 ? std::atoi(argv[1]) : 600;
+  if (frames <= 0)
+    frames = 600;
+
+  ImGui::SetAllocatorFunctions(AllocCounter::ImGuiAlloc,
+                               AllocCounter::ImGuiFree);
+  ImGui::CreateContext();
+  ImGuiIO &io = ImGui::GetIO();
+  io.DisplaySize = ImVec2(1920, 1080);
+  io.IniFilename = nullptr;
+  unsigned char *pixels = nullptr;
+  int width = 0, height = 0;
+  io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+
+  // Simulated clock: a fixed time of day advancing 16ms per frame
+  int64_t simulatedMs = 1759262400000LL;
+  FrameClock::SetSource([&simulatedMs]() { return simulatedMs; });
+
+  AddonAPI_t api = MakeStubApi();
+  TrainManager manager("/tmp/tc_ui_bench");
+  manager.GetTrains() = Synthetic::MakeTrains(10, 1000);
+  manager.SetActiveTrain(0);
+  for (int i = 0; i < 500; ++i)
+    manager.NextStep();
+
+  EventCatalog catalog("/tmp/tc_ui_bench");
+  while (catalog.IsFetching())
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  catalog.SetEvents(Synthetic::MakeCatalog());
+
+  EventUI eventUI(&api, &manager, &catalog);
+  EditorUI editorUI(&api, &manager, &eventUI);
+  OverlayUI overlayUI(&api, &manager, &catalog);
+  eventUI.Show();
+  editorUI.Show();
+  editorUI.Select(0, 500);
+
+  WindowStats editorStats{"EditorUI::Render"};
+  WindowStats overlayStats{"OverlayUI::Render"};
+  WindowStats eventStats{"EventUI::Render"};
+  WindowStats newFrameStats{"ImGui::NewFrame"};
+  WindowStats renderStats{"ImGui::Render"};
+
+  for (int f = 0; f < frames; ++f) {
+    io.DeltaTime = 1.0f / 60.0f;
+    io.MousePos = ImVec2(600.0f, 300.0f);
+    simulatedMs += 16;
+    FrameClock clock = FrameClock::Now();
+
+    Measure(newFrameStats, [] { ImGui::NewFrame(); });
+    Measure(editorStats, [&] { editorUI.Render(clock); });
+    Measure(overlayStats, [&] { overlayUI.Render(clock); });
+    Measure(eventStats, [&] { eventUI.Render(clock); });
+    Measure(renderStats, [] { ImGui::Render(); });
+  }
+
+  printf("%d frames, %zu trains x %zu steps, 5000 catalog events\n\n", frames,
+         manager.GetTrains().size(), manager.GetTrains()[0].Steps.size());
+  printf("%-24s %10s %10s %10s %10s %12s\n", "window", "mean us", "p50 us",
+         "p95 us", "p99 us", "allocs/frame");
+  for (WindowStats *stats :
+       {&editorStats, &overlayStats, &eventStats, &newFrameStats,
+        &renderStats}) {
+    printf("%-24s %10.1f %10.1f %10.1f %10.1f %12.1f\n", stats->Name,
+           BenchUtil::Mean(stats->CpuMicros),
+           BenchUtil::Percentile(stats->CpuMicros, 0.50),
+           BenchUtil::Percentile(stats->CpuMicros, 0.95),
+           BenchUtil::Percentile(stats->CpuMicros, 0.99),
+           static_cast<double>(stats->Allocations) / frames);
+  }
+
+  FrameClock::SetSource(nullptr);
+  ImGui::DestroyContext();
+  return 0;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+// Minimal stand-in for <windows.h> so the addon sources (and Nexus.h) can be
+// compiled on Linux for benchmarking. Only what the addon touches is here;
+// the calls are inert or do the obvious POSIX equivalent.
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <sys/stat.h>
+#include <unistd.h>
+
+typedef int BOOL;
+typedef unsigned int UINT;
+typedef unsigned long DWORD;
+typedef void *HANDLE;
+typedef void *HMODULE;
+typedef void *HWND;
+typedef void *LPVOID;
+typedef uintptr_t WPARAM;
+typedef intptr_t LPARAM;
+typedef intptr_t LRESULT;
+
+#define TRUE 1
+#define FALSE 0
+#define APIENTRY
+#define __stdcall
+#define __declspec(x)
+
+#define DLL_PROCESS_DETACH 0
+#define DLL_PROCESS_ATTACH 1
+#define DLL_THREAD_ATTACH 2
+#define DLL_THREAD_DETACH 3
+
+#define WM_KEYDOWN 0x0100
+#define WM_KEYUP 0x0101
+#define WM_CHAR 0x0102
+#define VK_RETURN 0x0D
+
+#define CP_UTF8 65001
+#define INVALID_FILE_ATTRIBUTES ((DWORD)-1)
+
+inline BOOL CreateDirectoryA(const char *path, void *) {
+  return mkdir(path, 0755) == 0;
+}
+
+inline DWORD GetFileAttributesA(const char *path) {
+  struct stat st;
+  return stat(path, &st) == 0 ? 0 : INVALID_FILE_ATTRIBUTES;
+}
+
+inline BOOL DeleteFileA(const char *path) { return unlink(path) == 0; }
+
+inline int gmtime_s(struct tm *out, const time_t *t) {
+  return gmtime_r(t, out) ? 0 : 1;
+}
+
+// UTF-8 only; returns the number of wide characters like the real API
+inline int MultiByteToWideChar(UINT, DWORD, const char *in, int inLen,
+                               wchar_t *out, int outLen) {
+  int count = 0;
+  for (int i = 0; i < inLen;) {
+    unsigned char c = static_cast<unsigned char>(in[i]);
+    int len = c < 0x80 ? 1 : (c >> 5) == 0x6 ? 2 : (c >> 4) == 0xE ? 3 : 4;
+    uint32_t cp = len == 1 ? c : c & (0x3F >> (len - 1));
+    for (int k = 1; k < len && i + k < inLen; ++k)
+      cp = (cp << 6) | (static_cast<unsigned char>(in[i + k]) & 0x3F);
+    if (out && count < outLen)
+      out[count] = static_cast<wchar_t>(cp);
+    count++;
+    i += len;
+  }
+  return count;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+// Inert WinINet stand-in: every request fails, so EventCatalog falls back to
+// an empty schedule that the benchmarks replace with synthetic data.
+
+#include "windows.h"
+
+typedef void *HINTERNET;
+
+#define INTERNET_OPEN_TYPE_PRECONFIG 0
+#define INTERNET_FLAG_RELOAD 0x80000000
+#define INTERNET_FLAG_SECURE 0x00800000
+
+inline HINTERNET InternetOpenA(const char *, DWORD, const char *, const char *,
+                               DWORD) {
+  return nullptr;
+}
+
+inline HINTERNET InternetOpenUrlA(HINTERNET, const char *, const char *, DWORD,
+                                  DWORD, uintptr_t) {
+  return nullptr;
+}
+
+inline BOOL InternetReadFile(HINTERNET, void *, DWORD, DWORD *read) {
+  if (read)
+    *read = 0;
+  return FALSE;
+}
+
+inline BOOL InternetCloseHandle(HINTERNET) { return TRUE; }
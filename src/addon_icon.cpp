@@ -0,0 +1,22 @@
+#include "addon_icon.h"
+#include "premium_icon.h"
+
+const char *const AddonIcon::kId = "TC_ICON";
+
+Texture_t *AddonIcon::Get(AddonAPI_t *api) {
+  static bool s_Requested = false;
+  static Texture_t *s_Texture = nullptr;
+  if (s_Texture || !api)
+    return s_Texture;
+
+  if (!s_Requested && api->Textures_GetOrCreateFromMemory) {
+    s_Requested = true;
+    // Nexus copies the bytes, which live in read-only data anyway
+    s_Texture = api->Textures_GetOrCreateFromMemory(
+        kId, const_cast<unsigned char *>(PREMIUM_ICON_PNG.data()),
+        PREMIUM_ICON_PNG.size());
+  } else if (api->Textures_Get) {
+    s_Texture = api->Textures_Get(kId);
+  }
+  return s_Texture;
+}
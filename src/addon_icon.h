@@ -0,0 +1,15 @@
+#pragma once
+#include "nexus/Nexus.h"
+
+// The addon's icon texture ("TC_ICON"). The PNG is compiled into the DLL;
+// it is handed to Nexus the first time anything asks for the texture
+// rather than during AddonLoad.
+namespace AddonIcon {
+
+extern const char *const kId;
+
+// Registers the texture on the first call. Null until Nexus has created it,
+// so callers retry on a later frame.
+Texture_t *Get(AddonAPI_t *api);
+
+} // namespace AddonIcon
@@ -1,47 +1,381 @@
 #include "base64.h"
 
-static const std::string base64_chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
-                                        "abcdefghijklmnopqrstuvwxyz"
-                                        "0123456789+/";
-
-static inline bool is_base64(unsigned char c) {
-  return (isalnum(c) || (c == '+') || (c == '/'));
-}
-
-std::string Base64::Encode(const std::string &in) {
-  std::string out;
-  int val = 0, valb = -6;
-  for (unsigned char c : in) {
-    val = (val << 8) + c;
-    valb += 8;
-    while (valb >= 0) {
-      out.push_back(base64_chars[(val >> valb) & 0x3F]);
-      valb -= 6;
-    }
+#include <atomic>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) ||             \
+    defined(__i386__)
+#define TC_BASE64_SIMD 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define TC_SSE41
+#else
+// GCC/Clang only emit SSE4.1 inside functions that ask for it, so the rest
+// of the build keeps the baseline instruction set
+#define TC_SSE41 __attribute__((target("sse4.1")))
+#endif
+#else
+#define TC_BASE64_SIMD 0
+#endif
+
+namespace {
+
+struct Alphabet {
+  char Chars[64];
+  int8_t Values[256]; // -1 outside the alphabet
+};
+
+constexpr Alphabet MakeAlphabet(char char62, char char63) {
+  Alphabet a{};
+  for (int i = 0; i < 26; ++i) {
+    a.Chars[i] = static_cast<char>('A' + i);
+    a.Chars[26 + i] = static_cast<char>('a' + i);
   }
-  if (valb > -6)
-    out.push_back(base64_chars[((val << 8) >> (valb + 8)) & 0x3F]);
-  while (out.size() % 4)
-    out.push_back('=');
-  return out;
+  for (int i = 0; i < 10; ++i)
+    a.Chars[52 + i] = static_cast<char>('0' + i);
+  a.Chars[62] = char62;
+  a.Chars[63] = char63;
+  for (int i = 0; i < 256; ++i)
+    a.Values[i] = -1;
+  for (int i = 0; i < 64; ++i)
+    a.Values[static_cast<unsigned char>(a.Chars[i])] = static_cast<int8_t>(i);
+  return a;
 }
 
-std::string Base64::Decode(const std::string &in) {
-  std::string out;
-  std::vector<int> T(256, -1);
-  for (int i = 0; i < 64; i++)
-    T[base64_chars[i]] = i;
+constexpr Alphabet kStandard = MakeAlphabet('+', '/');
+constexpr Alphabet kUrl = MakeAlphabet('-', '_');
+
+size_t EncodeScalar(const unsigned char *in, size_t size, char *out,
+                    const Alphabet &a, bool pad) {
+  char *start = out;
+  size_t i = 0;
+  for (; size - i >= 3; i += 3) {
+    uint32_t v = (in[i] << 16) | (in[i + 1] << 8) | in[i + 2];
+    *out++ = a.Chars[v >> 18];
+    *out++ = a.Chars[(v >> 12) & 0x3F];
+    *out++ = a.Chars[(v >> 6) & 0x3F];
+    *out++ = a.Chars[v & 0x3F];
+  }
+  size_t rest = size - i;
+  if (rest) {
+    uint32_t v = (in[i] << 16) | (rest == 2 ? in[i + 1] << 8 : 0);
+    *out++ = a.Chars[v >> 18];
+    *out++ = a.Chars[(v >> 12) & 0x3F];
+    if (rest == 2)
+      *out++ = a.Chars[(v >> 6) & 0x3F];
+    else if (pad)
+      *out++ = '=';
+    if (pad)
+      *out++ = '=';
+  }
+  return out - start;
+}
 
-  int val = 0, valb = -8;
-  for (unsigned char c : in) {
-    if (T[c] == -1)
+size_t DecodeScalar(const unsigned char *in, size_t size, char *out,
+                    const Alphabet &a) {
+  char *start = out;
+  size_t i = 0;
+  for (; size - i >= 4; i += 4) {
+    int v0 = a.Values[in[i]], v1 = a.Values[in[i + 1]],
+        v2 = a.Values[in[i + 2]], v3 = a.Values[in[i + 3]];
+    if ((v0 | v1 | v2 | v3) < 0)
       break;
-    val = (val << 6) + T[c];
-    valb += 6;
-    if (valb >= 0) {
-      out.push_back(char((val >> valb) & 0xFF));
-      valb -= 8;
+    uint32_t v = (v0 << 18) | (v1 << 12) | (v2 << 6) | v3;
+    *out++ = static_cast<char>(v >> 16);
+    *out++ = static_cast<char>(v >> 8);
+    *out++ = static_cast<char>(v);
+  }
+
+  // Up to three characters before the end or the first invalid byte; the
+  // bits of a lone trailing character are dropped
+  uint32_t acc = 0;
+  int count = 0;
+  for (; i < size && count < 3 && a.Values[in[i]] >= 0; ++i, ++count)
+    acc = (acc << 6) | static_cast<uint32_t>(a.Values[in[i]]);
+  if (count >= 2)
+    *out++ = static_cast<char>(acc >> (6 * count - 8));
+  if (count == 3)
+    *out++ = static_cast<char>(acc >> 2);
+  return out - start;
+}
+
+#if TC_BASE64_SIMD
+
+bool CpuHasSse41() {
+#ifdef _MSC_VER
+  int info[4];
+  __cpuid(info, 1);
+  return (info[2] & (1 << 9)) && (info[2] & (1 << 19)); // SSSE3, SSE4.1
+#else
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("ssse3") && __builtin_cpu_supports("sse4.1");
+#endif
+}
+
+std::atomic<bool> g_SimdEnabled{true};
+
+bool UseSimd() {
+  static const bool supported = CpuHasSse41();
+  return supported && g_SimdEnabled.load(std::memory_order_relaxed);
+}
+
+// 12 input bytes to 16 characters per step (W. Mula's pshufb method).
+// Returns the input consumed, a multiple of 12.
+TC_SSE41 size_t EncodeSse(const unsigned char *in, size_t size, char *out,
+                          const Alphabet &a) {
+  // Offset from 6-bit value to character, per value range
+  const __m128i shiftLut = _mm_setr_epi8(
+      'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+      '0' - 52, '0' - 52, '0' - 52, '0' - 52, static_cast<char>(a.Chars[62] - 62),
+      static_cast<char>(a.Chars[63] - 63), 'A', 0, 0);
+  size_t i = 0;
+  // Each load reads 16 bytes but consumes 12
+  for (; size - i >= 16; i += 12, out += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+    v = _mm_shuffle_epi8(
+        v, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+    __m128i hi = _mm_mulhi_epu16(_mm_and_si128(v, _mm_set1_epi32(0x0fc0fc00)),
+                                 _mm_set1_epi32(0x04000040));
+    __m128i lo = _mm_mullo_epi16(_mm_and_si128(v, _mm_set1_epi32(0x003f03f0)),
+                                 _mm_set1_epi32(0x01000010));
+    __m128i values = _mm_or_si128(hi, lo);
+
+    __m128i range = _mm_subs_epu8(values, _mm_set1_epi8(51));
+    __m128i upper = _mm_cmpgt_epi8(_mm_set1_epi8(26), values);
+    range = _mm_or_si128(range, _mm_and_si128(upper, _mm_set1_epi8(13)));
+    __m128i chars = _mm_add_epi8(_mm_shuffle_epi8(shiftLut, range), values);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out), chars);
+  }
+  return i;
+}
+
+// 16 characters to 12 bytes per step; stops before the first block holding
+// a byte outside the alphabet and returns the input consumed. Each store
+// writes 16 bytes, so a block is only taken with 24 characters left: the
+// output buffer then still has room for the 4 extra bytes.
+TC_SSE41 size_t DecodeSse(const unsigned char *in, size_t size, char *out,
+                          bool url) {
+  // Validation by nibble: a byte is valid when its low and high nibble
+  // classes share no bit
+  const __m128i lutLo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                      0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B,
+                                      0x1B, 0x1A);
+  const __m128i lutHi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04,
+                                      0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+                                      0x10, 0x10);
+  // Offset from character to 6-bit value, by high nibble ('/' at index 1)
+  const __m128i lutRoll =
+      _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+  const __m128i mask2F = _mm_set1_epi8(0x2F);
+
+  size_t i = 0;
+  for (; size - i >= 24; i += 16, out += 12) {
+    __m128i str = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+    if (url) {
+      // Map onto the standard alphabet, where '+' and '/' are not valid
+      __m128i foreign =
+          _mm_or_si128(_mm_cmpeq_epi8(str, _mm_set1_epi8('+')),
+                       _mm_cmpeq_epi8(str, _mm_set1_epi8('/')));
+      if (!_mm_testz_si128(foreign, foreign))
+        break;
+      str = _mm_blendv_epi8(str, _mm_set1_epi8('+'),
+                            _mm_cmpeq_epi8(str, _mm_set1_epi8('-')));
+      str = _mm_blendv_epi8(str, _mm_set1_epi8('/'),
+                            _mm_cmpeq_epi8(str, _mm_set1_epi8('_')));
     }
+
+    __m128i hiNibbles = _mm_and_si128(_mm_srli_epi32(str, 4), mask2F);
+    __m128i lo = _mm_shuffle_epi8(lutLo, _mm_and_si128(str, mask2F));
+    __m128i hi = _mm_shuffle_epi8(lutHi, hiNibbles);
+    if (!_mm_testz_si128(lo, hi))
+      break;
+
+    __m128i isSlash = _mm_cmpeq_epi8(str, mask2F);
+    __m128i roll = _mm_shuffle_epi8(lutRoll, _mm_add_epi8(isSlash, hiNibbles));
+    __m128i values = _mm_add_epi8(str, roll);
+
+    // Pack four 6-bit values per lane into three bytes, big endian
+    __m128i merged =
+        _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+    merged = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+    merged = _mm_shuffle_epi8(merged, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8,
+                                                    14, 13, 12, -1, -1, -1,
+                                                    -1));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out), merged);
   }
+  return i;
+}
+
+#endif
+
+size_t EncodeWith(std::string_view in, char *out, const Alphabet &a,
+                  bool pad) {
+  auto bytes = reinterpret_cast<const unsigned char *>(in.data());
+  size_t done = 0;
+#if TC_BASE64_SIMD
+  if (UseSimd())
+    done = EncodeSse(bytes, in.size(), out, a);
+#endif
+  size_t written = done / 3 * 4;
+  return written +
+         EncodeScalar(bytes + done, in.size() - done, out + written, a, pad);
+}
+
+size_t DecodeWith(std::string_view in, char *out, const Alphabet &a) {
+  auto bytes = reinterpret_cast<const unsigned char *>(in.data());
+  size_t done = 0;
+#if TC_BASE64_SIMD
+  if (UseSimd())
+    done = DecodeSse(bytes, in.size(), out, &a == &kUrl);
+#endif
+  size_t written = done / 4 * 3;
+  return written + DecodeScalar(bytes + done, in.size() - done, out + written, a);
+}
+
+} // namespace
+
+size_t Base64::EncodedSize(size_t size) { return (size + 2) / 3 * 4; }
+
+size_t Base64::EncodedUrlSize(size_t size) { return (size * 4 + 2) / 3; }
+
+size_t Base64::MaxDecodedSize(size_t size) {
+  size_t rest = size % 4;
+  return size / 4 * 3 + (rest > 1 ? rest - 1 : 0);
+}
+
+size_t Base64::Encode(std::string_view in, char *out) {
+  return EncodeWith(in, out, kStandard, true);
+}
+
+size_t Base64::EncodeUrl(std::string_view in, char *out) {
+  return EncodeWith(in, out, kUrl, false);
+}
+
+size_t Base64::Decode(std::string_view in, char *out) {
+  return DecodeWith(in, out, kStandard);
+}
+
+size_t Base64::DecodeUrl(std::string_view in, char *out) {
+  return DecodeWith(in, out, kUrl);
+}
+
+std::string Base64::Encode(std::string_view in) {
+  std::string out(EncodedSize(in.size()), '\0');
+  Encode(in, &out[0]);
+  return out;
+}
+
+std::string Base64::Decode(std::string_view in) {
+  std::string out(MaxDecodedSize(in.size()), '\0');
+  out.resize(Decode(in, &out[0]));
+  return out;
+}
+
+std::string Base64::EncodeUrl(std::string_view in) {
+  std::string out(EncodedUrlSize(in.size()), '\0');
+  EncodeUrl(in, &out[0]);
+  return out;
+}
+
+std::string Base64::DecodeUrl(std::string_view in) {
+  std::string out(MaxDecodedSize(in.size()), '\0');
+  out.resize(DecodeUrl(in, &out[0]));
   return out;
 }
+
+void Base64::SetSimdEnabled(bool enabled) {
+#if TC_BASE64_SIMD
+  g_SimdEnabled.store(enabled, std::memory_order_relaxed);
+#else
+  (void)enabled;
+#endif
+}
+
+bool Base64Decoder::Fail(Status status, size_t offset) {
+  m_Status = status;
+  m_ErrorOffset = offset;
+  return false;
+}
+
+void Base64Decoder::FlushGroup(std::string &out) {
+  // 2 characters carry one byte, 3 carry two, 4 carry three
+  uint32_t bits = m_Group << (6 * (4 - m_GroupSize));
+  out.push_back(static_cast<char>(bits >> 16));
+  if (m_GroupSize > 2)
+    out.push_back(static_cast<char>(bits >> 8));
+  if (m_GroupSize > 3)
+    out.push_back(static_cast<char>(bits));
+  m_Group = 0;
+  m_GroupSize = 0;
+}
+
+bool Base64Decoder::Feed(std::string_view chunk, std::string &out) {
+  if (m_Status != Status::Ok)
+    return false;
+  const Alphabet &a = m_Url ? kUrl : kStandard;
+
+  size_t i = 0;
+  while (i < chunk.size()) {
+    // Between groups, runs of plain alphabet go through the block decoder
+    if (m_GroupSize == 0 && m_Padding == 0) {
+      size_t run = i;
+      while (run < chunk.size() &&
+             a.Values[static_cast<unsigned char>(chunk[run])] >= 0)
+        run++;
+      size_t whole = (run - i) / 4 * 4;
+      if (whole) {
+        size_t at = out.size();
+        out.resize(at + whole / 4 * 3);
+        DecodeWith(chunk.substr(i, whole), &out[at], a);
+        i += whole;
+        continue;
+      }
+    }
+
+    char c = chunk[i];
+    int value = a.Values[static_cast<unsigned char>(c)];
+    if (value >= 0) {
+      if (m_Padding)
+        return Fail(Status::BadPadding, m_Offset + i);
+      m_Group = (m_Group << 6) | static_cast<uint32_t>(value);
+      if (++m_GroupSize == 4)
+        FlushGroup(out);
+    } else if (c == '=') {
+      // "xx==" or "xxx=", nothing else
+      if (m_GroupSize < 2 || m_GroupSize + m_Padding == 4)
+        return Fail(Status::BadPadding, m_Offset + i);
+      m_Padding++;
+    } else if (c != ' ' && c != '\t' && c != '\r' && c != '\n') {
+      return Fail(Status::InvalidCharacter, m_Offset + i);
+    }
+    i++;
+  }
+  m_Offset += chunk.size();
+  return true;
+}
+
+bool Base64Decoder::Finish(std::string &out) {
+  if (m_Status != Status::Ok)
+    return false;
+  if (m_Padding && m_GroupSize + m_Padding != 4)
+    return Fail(Status::BadPadding, m_Offset);
+  if (m_GroupSize == 1)
+    return Fail(Status::Truncated, m_Offset);
+  if (m_GroupSize)
+    FlushGroup(out);
+  m_Padding = 0;
+  return true;
+}
+
+const char *Base64Decoder::StatusText(Status status) {
+  switch (status) {
+  case Status::InvalidCharacter:
+    return "invalid character";
+  case Status::BadPadding:
+    return "misplaced padding";
+  case Status::Truncated:
+    return "text cut off";
+  default:
+    return "";
+  }
+}
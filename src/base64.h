@@ -1,9 +1,126 @@
 #pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <string>
-#include <vector>
+#include <string_view>
 
+// RFC 4648 Base64. Whole 12-byte groups go through SSE4.1 when the CPU has
+// it (checked once at runtime), everything else through a scalar loop with
+// constexpr tables; both produce identical output.
+//
+// Decoders stop at the first byte outside the alphabet (padding included)
+// and return what was decoded up to there.
 class Base64 {
 public:
-  static std::string Encode(const std::string &in);
-  static std::string Decode(const std::string &in);
+  // Exact output sizes for `size` input bytes
+  static size_t EncodedSize(size_t size);    // Padded
+  static size_t EncodedUrlSize(size_t size); // Unpadded
+  // Enough room for decoding `size` characters
+  static size_t MaxDecodedSize(size_t size);
+
+  // Write into a caller buffer of at least the sizes above and return the
+  // number of bytes written
+  static size_t Encode(std::string_view in, char *out);
+  static size_t EncodeUrl(std::string_view in, char *out);
+  static size_t Decode(std::string_view in, char *out);
+  static size_t DecodeUrl(std::string_view in, char *out);
+
+  static std::string Encode(std::string_view in);
+  static std::string Decode(std::string_view in);
+  // base64url: '-' and '_' instead of '+' and '/', no padding, so the text
+  // survives URLs and chat link detection intact
+  static std::string EncodeUrl(std::string_view in);
+  static std::string DecodeUrl(std::string_view in);
+
+  // Benchmarks compare against the scalar path; has no effect on CPUs
+  // without SSE4.1
+  static void SetSimdEnabled(bool enabled);
+
+  // Compile-time decoding of padded standard Base64, for data embedded in
+  // the binary. A character outside the alphabet fails the build:
+  //   constexpr size_t kSize = Base64::LiteralSize(kText);
+  //   constexpr auto kBytes = Base64::DecodeLiteral<kSize>(kText);
+  static constexpr size_t LiteralSize(std::string_view text) {
+    size_t size = text.size() / 4 * 3;
+    for (size_t i = text.size(); i > 0 && text[i - 1] == '='; --i)
+      size--;
+    return size;
+  }
+
+  template <size_t N>
+  static constexpr std::array<unsigned char, N>
+  DecodeLiteral(std::string_view text) {
+    std::array<unsigned char, N> bytes{};
+    uint32_t bits = 0;
+    int count = 0;
+    size_t out = 0;
+    for (char c : text) {
+      if (c == '=')
+        break;
+      bits = (bits << 6) | LiteralValue(c);
+      if (++count == 4) {
+        bytes[out++] = static_cast<unsigned char>(bits >> 16);
+        bytes[out++] = static_cast<unsigned char>(bits >> 8);
+        bytes[out++] = static_cast<unsigned char>(bits);
+        bits = 0;
+        count = 0;
+      }
+    }
+    bits <<= 6 * (4 - count);
+    if (count >= 2)
+      bytes[out++] = static_cast<unsigned char>(bits >> 16);
+    if (count == 3)
+      bytes[out++] = static_cast<unsigned char>(bits >> 8);
+    return out == N ? bytes : throw "Base64 literal does not match its size";
+  }
+
+private:
+  static constexpr uint32_t LiteralValue(char c) {
+    return c >= 'A' && c <= 'Z'   ? c - 'A'
+           : c >= 'a' && c <= 'z' ? c - 'a' + 26
+           : c >= '0' && c <= '9' ? c - '0' + 52
+           : c == '+'             ? 62
+           : c == '/'             ? 63
+                      : throw "invalid character in Base64 literal";
+  }
+};
+
+// Incremental, validating decoder for text typed or pasted by people.
+// Whitespace anywhere is skipped; '=' is only accepted as the padding of a
+// final 2- or 3-character group, and a missing padding is tolerated. Any
+// other byte stops decoding and records its offset in the input fed so far.
+class Base64Decoder {
+public:
+  enum class Status {
+    Ok,
+    InvalidCharacter, // Byte outside the alphabet and not whitespace
+    BadPadding,       // '=' out of place, or data after the padding
+    Truncated,        // Input ended one character into a group
+  };
+
+  explicit Base64Decoder(bool url = false) : m_Url(url) {}
+
+  // Appends the bytes decoded from `chunk` to `out`. Chunks may split the
+  // text anywhere. False once an error has been found.
+  bool Feed(std::string_view chunk, std::string &out);
+  // Flushes a final unpadded group; false if the input ended mid-group
+  bool Finish(std::string &out);
+
+  Status GetStatus() const { return m_Status; }
+  size_t GetErrorOffset() const { return m_ErrorOffset; }
+  // "invalid character" and so on; empty for Ok
+  static const char *StatusText(Status status);
+
+private:
+  bool Fail(Status status, size_t offset);
+  void FlushGroup(std::string &out);
+
+  bool m_Url;
+  Status m_Status = Status::Ok;
+  size_t m_Offset = 0; // Input bytes fed before the current chunk
+  size_t m_ErrorOffset = 0;
+  uint32_t m_Group = 0; // Values of the characters of an incomplete group
+  int m_GroupSize = 0;
+  int m_Padding = 0; // '=' seen after the group
 };
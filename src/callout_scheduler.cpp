@@ -0,0 +1,59 @@
+#include "callout_scheduler.h"
+
+static uint64_t Payload(size_t step, size_t callout) {
+  return (static_cast<uint64_t>(step) << 32) | callout;
+}
+
+int64_t CalloutScheduler::NextOccurrence(const TrainStep &step,
+                                         const Callout &callout,
+                                         int64_t now) {
+  return FrameClock::NextDailyOccurrence(
+      step.SpawnMinuteUTC * 60 + callout.OffsetSeconds, now);
+}
+
+void CalloutScheduler::Sync(const TrainTemplate *train, uint64_t revision,
+                            const FrameClock &clock) {
+  size_t stepCount = train ? train->Steps.size() : 0;
+  if (train == m_Train && revision == m_Revision && stepCount == m_StepCount)
+    return;
+  // An edit to the same train keeps the wheel's position, so callouts due
+  // since the last Update still fire on the next one; a newly activated
+  // train starts from now and never replays the past
+  int64_t from = train && train == m_Train ? m_Wheel.GetNow()
+                                           : clock.EpochSeconds;
+  m_Train = train;
+  m_Revision = revision;
+  m_StepCount = stepCount;
+
+  m_Wheel.Reset(from);
+  for (size_t s = 0; s < stepCount; ++s) {
+    const TrainStep &step = train->Steps[s];
+    if (step.SpawnMinuteUTC < 0)
+      continue;
+    for (size_t c = 0; c < step.Callouts.size(); ++c) {
+      m_Wheel.Schedule(NextOccurrence(step, step.Callouts[c], from),
+                       Payload(s, c));
+    }
+  }
+}
+
+void CalloutScheduler::Update(const FrameClock &clock, std::vector<Due> &due) {
+  if (!m_Train)
+    return;
+  int64_t now = clock.EpochSeconds;
+  m_Fired.clear();
+  m_Wheel.Advance(now, m_Fired);
+
+  for (uint64_t payload : m_Fired) {
+    size_t s = static_cast<size_t>(payload >> 32);
+    size_t c = static_cast<size_t>(payload & 0xFFFFFFFF);
+    if (s >= m_Train->Steps.size() || c >= m_Train->Steps[s].Callouts.size())
+      continue; // Edited without a revision bump; dropped until the next Sync
+    const TrainStep &step = m_Train->Steps[s];
+    const Callout &callout = step.Callouts[c];
+    int64_t next = NextOccurrence(step, callout, now);
+    m_Wheel.Schedule(next, payload);
+    if (now - (next - FrameClock::kSecondsPerDay) <= kMaxLatenessSeconds)
+      due.push_back({static_cast<int>(s), static_cast<int>(c)});
+  }
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include "frame_clock.h"
+#include "timer_wheel.h"
+#include "train_types.h"
+#include <cstdint>
+#include <vector>
+
+// Decides when the timed callouts of the active train fire. Every callout
+// sits in a TimerWheel ticking in epoch seconds at its next daily
+// occurrence, so a frame costs O(1) however many steps and callouts the
+// train has; a callout that fired is filed again a day later.
+class CalloutScheduler {
+public:
+  struct Due {
+    int StepIndex;
+    int CalloutIndex;
+  };
+
+  // Callouts more than this late (game paused, loading screen) are skipped
+  static const int kMaxLatenessSeconds = 30;
+
+  // Reschedules everything if the train or the library revision changed.
+  // A new train gets the occurrences after `clock`; the same train those
+  // after the last Update. Null clears the schedule.
+  void Sync(const TrainTemplate *train, uint64_t revision,
+            const FrameClock &clock);
+  // Appends the callouts that came due since the last call
+  void Update(const FrameClock &clock, std::vector<Due> &due);
+
+  size_t GetPendingCount() const { return m_Wheel.GetPendingCount(); }
+
+private:
+  // First time after `now` the callout fires
+  static int64_t NextOccurrence(const TrainStep &step, const Callout &callout,
+                                int64_t now);
+
+  TimerWheel m_Wheel;
+  const TrainTemplate *m_Train = nullptr;
+  uint64_t m_Revision = 0;
+  size_t m_StepCount = 0;
+  std::vector<uint64_t> m_Fired; // Reused by Update
+};
@@ -0,0 +1,194 @@
+#include "chat_queue.h"
+#include "chat_splitter.h"
+#include <windows.h>
+
+#include <algorithm>
+
+// Binds are held this long by GameBinds_InvokeAsync
+static const int kBindMilliseconds = 50;
+// Waited after a bind before typing or starting the next message; covers
+// the hold plus a frame or two for the game to react
+static const auto kBindSettle = std::chrono::milliseconds(120);
+
+bool ChatQueue::CanSend() const {
+  return m_API && m_API->WndProc_SendToGameOnly &&
+         (m_API->GameBinds_InvokeAsync ||
+          (m_API->GameBinds_Press && m_API->GameBinds_Release));
+}
+
+// Squad broadcasts go out as "/s <text>"
+static const size_t kCommanderPrefixLength = 3;
+
+size_t ChatQueue::MaxTextLength(bool asCommander) {
+  return kMaxLineLength - (asCommander ? kCommanderPrefixLength : 0);
+}
+
+bool ChatQueue::Post(const std::string &text, bool asCommander,
+                     Clock::time_point now) {
+  if (!CanSend())
+    return false;
+  ChatSplitter::Split(text, MaxTextLength(asCommander), m_Lines);
+  // All or nothing, so a message never goes out with its end missing
+  if (m_Lines.empty() || m_Queue.size() + m_Lines.size() > kMaxQueued)
+    return false;
+  bool oneLine = m_Lines.size() == 1;
+  if (oneLine && text == m_LastPost && asCommander == m_LastPostAsCommander &&
+      now - m_LastPostAt < kRepeatWindow)
+    return true; // Same button clicked twice
+  for (std::string_view line : m_Lines) {
+    if (!PostLine(line, asCommander))
+      return false;
+  }
+  if (oneLine) {
+    m_LastPost = text;
+    m_LastPostAsCommander = asCommander;
+    m_LastPostAt = now;
+  } else {
+    m_LastPost.clear();
+  }
+  return true;
+}
+
+bool ChatQueue::PostLine(std::string_view line, bool asCommander) {
+  // Convert UTF-8 to UTF-16 so we send proper wide characters
+  int req = MultiByteToWideChar(CP_UTF8, 0, line.data(), (int)line.size(),
+                                NULL, 0);
+  if (req <= 0)
+    return false;
+  std::wstring wide(req, L'\0');
+  MultiByteToWideChar(CP_UTF8, 0, line.data(), (int)line.size(), &wide[0],
+                      req);
+
+  // Merge into the last message if it has not started yet
+  if (m_Queue.size() > (IsFrontStarted() ? 1u : 0u)) {
+    Message &last = m_Queue.back();
+    if (last.AsCommander == asCommander) {
+      static const std::wstring kSeparator = L" | ";
+      if (last.Text.size() + kSeparator.size() + wide.size() <=
+          kMaxLineLength) {
+        last.Text += kSeparator;
+        last.Text += wide;
+        return true;
+      }
+    }
+  }
+  Message message;
+  // Many servers accept squad chat as commander channel; use /s prefix
+  message.Text = asCommander ? L"/s " + wide : wide;
+  message.AsCommander = asCommander;
+  m_Queue.push_back(std::move(message));
+  return true;
+}
+
+void ChatQueue::Update(Clock::time_point now) {
+  if (m_LastUpdate != Clock::time_point()) {
+    // Hitches (loading screens) would skew the estimate for a long time
+    auto frame = std::min<Clock::duration>(now - m_LastUpdate,
+                                           std::chrono::milliseconds(250));
+    m_FrameTime = (m_FrameTime * 7 + frame) / 8;
+  }
+  m_LastUpdate = now;
+  if (!CanSend())
+    return;
+
+  switch (m_Stage) {
+  case Stage::Idle:
+    if (m_Queue.empty() || now < m_LastSubmit + kMinSpacing ||
+        !m_Bucket.TryTake(now))
+      return;
+    InvokeBind(m_Queue.front().AsCommander ? GB_UiSquadBroadcastChatFocus
+                                           : GB_UiChatFocus);
+    m_Index = 0;
+    m_WaitUntil = now + kBindSettle;
+    m_Stage = Stage::Focusing;
+    return;
+
+  case Stage::Focusing:
+    if (now < m_WaitUntil)
+      return;
+    m_Stage = Stage::Typing;
+    // Typing starts this frame
+    [[fallthrough]];
+
+  case Stage::Typing: {
+    const Message &message = m_Queue.front();
+    size_t end = std::min(message.Text.size(),
+                          m_Index + static_cast<size_t>(m_CharsPerFrame));
+    for (; m_Index < end; ++m_Index) {
+      m_API->WndProc_SendToGameOnly(NULL, WM_CHAR,
+                                    (WPARAM)message.Text[m_Index], 0);
+    }
+    if (m_Index < message.Text.size())
+      return;
+
+    if (message.AsCommander) {
+      InvokeBind(GB_UiSquadBroadcastChatCommand);
+    } else {
+      m_API->WndProc_SendToGameOnly(NULL, WM_KEYDOWN, VK_RETURN, 0);
+      m_API->WndProc_SendToGameOnly(NULL, WM_KEYUP, VK_RETURN, 0);
+    }
+    m_Queue.pop_front();
+    m_LastSubmit = now;
+    m_WaitUntil = now + kBindSettle;
+    m_Stage = Stage::Settling;
+    return;
+  }
+
+  case Stage::Settling:
+    if (now >= m_WaitUntil)
+      m_Stage = Stage::Idle;
+    return;
+  }
+}
+
+ChatQueue::Clock::duration
+ChatQueue::EstimateDrainTime(Clock::time_point now) const {
+  // Replays the queue against a copy of the throttle
+  TokenBucket bucket = m_Bucket;
+  Clock::time_point ready = now;
+  Clock::time_point lastSubmit = m_LastSubmit;
+  size_t next = 0;
+  if (IsFrontStarted()) {
+    Clock::time_point typing = std::max(now, m_WaitUntil);
+    lastSubmit = typing + TypingTime(m_Queue.front().Text.size() - m_Index);
+    ready = lastSubmit + kBindSettle;
+    next = 1;
+  } else if (m_Stage == Stage::Settling) {
+    ready = std::max(now, m_WaitUntil);
+  }
+
+  for (; next < m_Queue.size(); ++next) {
+    Clock::time_point start =
+        bucket.NextAvailable(std::max(ready, lastSubmit + kMinSpacing));
+    bucket.TryTake(start);
+    lastSubmit = start + kBindSettle + TypingTime(m_Queue[next].Text.size());
+    ready = lastSubmit + kBindSettle;
+  }
+  return std::max<Clock::duration>(lastSubmit - now, Clock::duration::zero());
+}
+
+void ChatQueue::Clear() {
+  if (m_Stage == Stage::Focusing || m_Stage == Stage::Typing)
+    m_Queue.erase(m_Queue.begin() + 1, m_Queue.end());
+  else
+    m_Queue.clear();
+}
+
+void ChatQueue::SetCharsPerFrame(int chars) {
+  m_CharsPerFrame = std::max(1, chars);
+}
+
+ChatQueue::Clock::duration ChatQueue::TypingTime(size_t chars) const {
+  size_t frames = (chars + m_CharsPerFrame - 1) / m_CharsPerFrame;
+  return m_FrameTime * static_cast<int64_t>(frames);
+}
+
+void ChatQueue::InvokeBind(EGameBinds bind) {
+  // Prefer the async invoke so the render thread never blocks
+  if (m_API->GameBinds_InvokeAsync) {
+    m_API->GameBinds_InvokeAsync(bind, kBindMilliseconds);
+  } else {
+    m_API->GameBinds_Press(bind);
+    m_API->GameBinds_Release(bind);
+  }
+}
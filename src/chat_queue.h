@@ -0,0 +1,98 @@
+#pragma once
+#include "nexus/Nexus.h"
+#include "token_bucket.h"
+
+#include <chrono>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Types messages into the game chat a few characters per frame. Messages
+// wait in a FIFO; each one focuses the chat input, waits for that game bind
+// to finish, types its characters within the per-frame budget and submits.
+// Call Update once per frame.
+//
+// The game silently drops chat lines sent too quickly, so messages start
+// only when a token bucket allows it and at least kMinSpacing after the
+// previous submit. Messages queued behind each other on the same channel
+// are merged while they fit in one chat line; text too long for one line is
+// cut by ChatSplitter and queued as several, in order.
+class ChatQueue {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  static const int kDefaultCharsPerFrame = 16;
+  static const size_t kMaxQueued = 16;
+  // Characters the game's chat input accepts, including the "/s " prefix
+  static const size_t kMaxLineLength = 199;
+  // The throttle is undocumented; these stay clear of it in practice
+  static const int kBurst = 3;
+  static constexpr std::chrono::seconds kRefillInterval{3};
+  static constexpr std::chrono::milliseconds kMinSpacing{1000};
+  // A one-line post repeated within this window is taken for a double
+  // click and dropped
+  static constexpr std::chrono::milliseconds kRepeatWindow{500};
+
+  explicit ChatQueue(AddonAPI_t *api)
+      : m_API(api), m_Bucket(kBurst, kRefillInterval) {}
+
+  // False if the Nexus API cannot drive the chat
+  bool CanSend() const;
+  // Queues `text` (UTF-8) for squad broadcast, or for the current chat
+  // channel. False if it cannot be sent or the queue is full.
+  bool Post(const std::string &text, bool asCommander = true,
+            Clock::time_point now = Clock::now());
+  // Room for text on one chat line, after the channel prefix
+  static size_t MaxTextLength(bool asCommander);
+  void Update(Clock::time_point now);
+  // Drops queued messages; one being typed is still finished
+  void Clear();
+
+  int GetCharsPerFrame() const { return m_CharsPerFrame; }
+  void SetCharsPerFrame(int chars);
+
+  // Queued messages, including the one being sent
+  size_t GetPendingCount() const { return m_Queue.size(); }
+  bool IsBusy() const { return !m_Queue.empty() || m_Stage != Stage::Idle; }
+  // Expected time until the last queued message is submitted, from the
+  // throttle and the recent frame rate
+  Clock::duration EstimateDrainTime(Clock::time_point now) const;
+
+private:
+  enum class Stage {
+    Idle,
+    Focusing, // Waiting for the focus bind to open the input
+    Typing,
+    Settling, // Waiting for the submit to go through before the next one
+  };
+
+  struct Message {
+    std::wstring Text;
+    bool AsCommander = true;
+  };
+
+  bool PostLine(std::string_view line, bool asCommander);
+  void InvokeBind(EGameBinds bind);
+  bool IsFrontStarted() const {
+    return m_Stage == Stage::Focusing || m_Stage == Stage::Typing;
+  }
+  Clock::duration TypingTime(size_t chars) const;
+
+  AddonAPI_t *m_API;
+  std::deque<Message> m_Queue;
+  std::vector<std::string_view> m_Lines; // Reused by Post
+  Stage m_Stage = Stage::Idle;
+  size_t m_Index = 0; // Next character of the front message
+  Clock::time_point m_WaitUntil;
+  int m_CharsPerFrame = kDefaultCharsPerFrame;
+  TokenBucket m_Bucket;
+  Clock::time_point m_LastSubmit;
+  // Last one-line post, for the double click check; empty after others
+  std::string m_LastPost;
+  bool m_LastPostAsCommander = true;
+  Clock::time_point m_LastPostAt;
+  // Smoothed time between Update calls, for the estimate
+  Clock::duration m_FrameTime = std::chrono::milliseconds(16);
+  Clock::time_point m_LastUpdate;
+};
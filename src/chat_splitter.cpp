@@ -0,0 +1,124 @@
+#include "chat_splitter.h"
+
+namespace {
+
+bool IsSpace(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+bool IsLinkStart(std::string_view text, size_t i) {
+  return text[i] == '[' && i + 1 < text.size() && text[i + 1] == '&';
+}
+
+// Bytes of the sequence starting at `i`; stray continuation bytes and
+// truncated sequences count as single characters
+size_t SequenceLength(std::string_view text, size_t i) {
+  unsigned char lead = static_cast<unsigned char>(text[i]);
+  size_t length = lead < 0xC0 ? 1 : lead < 0xE0 ? 2 : lead < 0xF0 ? 3 : 4;
+  if (i + length > text.size())
+    return 1;
+  for (size_t k = 1; k < length; ++k) {
+    if ((static_cast<unsigned char>(text[i + k]) & 0xC0) != 0x80)
+      return 1;
+  }
+  return length;
+}
+
+// Four-byte sequences are surrogate pairs in UTF-16
+size_t Units(size_t sequenceLength) { return sequenceLength == 4 ? 2 : 1; }
+
+} // namespace
+
+size_t ChatSplitter::Length(std::string_view text) {
+  size_t units = 0;
+  for (size_t i = 0; i < text.size();) {
+    size_t length = SequenceLength(text, i);
+    units += Units(length);
+    i += length;
+  }
+  return units;
+}
+
+void ChatSplitter::Split(std::string_view text, size_t maxLength,
+                         std::vector<std::string_view> &out) {
+  out.clear();
+  if (maxLength == 0)
+    return;
+
+  const size_t none = std::string_view::npos;
+  size_t lineStart = none; // Open chat line, [lineStart, lineEnd)
+  size_t lineEnd = 0;
+  size_t lineUnits = 0;
+  auto flush = [&] {
+    if (lineStart != none)
+      out.push_back(text.substr(lineStart, lineEnd - lineStart));
+    lineStart = none;
+  };
+
+  size_t i = 0;
+  while (i < text.size()) {
+    if (text[i] == '\n') {
+      flush();
+      i++;
+      continue;
+    }
+    if (IsSpace(text[i])) {
+      i++;
+      continue;
+    }
+
+    // Next atom: a whole chat link, or a word up to whitespace or a link
+    size_t end = i;
+    size_t units = 0;
+    bool link = false;
+    if (IsLinkStart(text, i)) {
+      size_t close = text.find_first_of("] \t\r\n", i);
+      if (close != none && text[close] == ']') {
+        link = true;
+        end = close + 1;
+        units = Length(text.substr(i, end - i));
+      }
+    }
+    if (!link) {
+      do {
+        size_t length = SequenceLength(text, end);
+        units += Units(length);
+        end += length;
+      } while (end < text.size() && text[end] != '\n' &&
+               !IsSpace(text[end]) && !IsLinkStart(text, end));
+    }
+
+    // Whitespace between the atoms stays as typed (it is all ASCII)
+    size_t gap = lineStart == none ? 0 : i - lineEnd;
+    if (lineStart != none && lineUnits + gap + units <= maxLength) {
+      lineUnits += gap + units;
+      lineEnd = end;
+      i = end;
+      continue;
+    }
+    flush();
+    if (units <= maxLength) {
+      lineStart = i;
+      lineEnd = end;
+      lineUnits = units;
+      i = end;
+      continue;
+    }
+
+    // Longer than a whole line: full lines of characters, the rest stays
+    // open for whatever follows
+    lineStart = i;
+    lineUnits = 0;
+    while (i < end) {
+      size_t length = SequenceLength(text, i);
+      if (lineUnits > 0 && lineUnits + Units(length) > maxLength) {
+        lineEnd = i;
+        flush();
+        lineStart = i;
+        lineUnits = 0;
+      }
+      lineUnits += Units(length);
+      i += length;
+    }
+    lineEnd = end;
+  }
+  flush();
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+// Cuts text into chat lines of at most `maxLength` UTF-16 units, the unit
+// the game's input limit counts in. Lines break at whitespace, and each
+// line of the input starts a new chat line. Chat links ("[&...]") are never
+// cut; neither are UTF-8 sequences. A single word longer than a line is cut
+// between characters.
+//
+// The pieces are views into `text` without surrounding whitespace, and
+// `out` is reused, so this is cheap enough to run on every keypress.
+class ChatSplitter {
+public:
+  static void Split(std::string_view text, size_t maxLength,
+                    std::vector<std::string_view> &out);
+  // UTF-16 units needed for `text`
+  static size_t Length(std::string_view text);
+};
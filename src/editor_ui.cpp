@@ -1,18 +1,16 @@
 #define _CRT_SECURE_NO_WARNINGS
 #include "editor_ui.h"
+#include "chat_queue.h"
+#include "chat_splitter.h"
 #include "event_ui.h"
 #include "imgui/imgui.h"
 #include <string>
 #include "train_types.h"
 
 EditorUI::EditorUI(AddonAPI_t *api, TrainManager *manager, EventUI *eventUI)
-    : m_API(api), m_Manager(manager), m_EventUI(eventUI) {
-  if (m_API && m_API->Textures_Get) {
-    m_Icon = m_API->Textures_Get("TC_ICON");
-  }
-}
+    : m_API(api), m_Manager(manager), m_EventUI(eventUI) {}
 
-void EditorUI::Render() {
+void EditorUI::Render(const FrameClock &clock) {
   if (!m_Visible || !m_Manager)
     return;
 
@@ -56,24 +54,46 @@ void EditorUI::Render() {
       newTrain.Author = "Me";
       trains.push_back(newTrain);
       m_SelectedTrainIndex = trains.size() - 1;
+      m_Manager->MarkDirty();
     }
     if (ImGui::Button("Paste from Clipboard", ImVec2(-1, 0))) {
       const char *clip = ImGui::GetClipboardText();
+      m_ImportError = clip ? "" : "clipboard is empty";
       if (clip) {
-        if (m_Manager->ImportFromClipboard(clip)) {
+        if (m_Manager->ImportFromClipboard(clip, &m_ImportError)) {
           m_SelectedTrainIndex = trains.size() - 1;
+          m_ImportError.clear();
         }
       }
     }
+    if (!m_ImportError.empty()) {
+      ImGui::PushTextWrapPos(0.0f);
+      ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "Import failed: %s",
+                         m_ImportError.c_str());
+      ImGui::PopTextWrapPos();
+    }
 
     ImGui::Spacing();
     if (ImGui::Button("Save Trains API")) {
-      m_Manager->SaveTrains();
-      ImGui::OpenPopup("Save Success");
+      // Written right here rather than by the autosave worker, so the popup
+      // reports what actually reached the disk
+      m_SaveFailed = !m_Manager->SaveTrains();
+      ImGui::OpenPopup("Save Result");
     }
-    if (ImGui::BeginPopupModal("Save Success", NULL,
+    if (m_Manager->LastWriteFailed() && !m_Manager->IsReadOnly())
+      ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f),
+                         "Last save failed; retrying.");
+    if (ImGui::BeginPopupModal("Save Result", NULL,
                                ImGuiWindowFlags_AlwaysAutoResize)) {
-      ImGui::Text("All trains saved to addons directory!");
+      if (m_SaveFailed && m_Manager->IsReadOnly())
+        ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f),
+                           "The library could not be read at startup; saving "
+                           "is off so the files on disk stay intact.");
+      else if (m_SaveFailed)
+        ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f),
+                           "Saving failed; autosave will keep retrying.");
+      else
+        ImGui::Text("All trains saved to addons directory!");
       if (ImGui::Button("OK", ImVec2(120, 0))) {
         ImGui::CloseCurrentPopup();
       }
@@ -85,6 +105,8 @@ void EditorUI::Render() {
     // Details View
     if (m_SelectedTrainIndex >= 0 &&
         m_SelectedTrainIndex < static_cast<int>(trains.size())) {
+      // Loads the steps on first selection and keeps them resident
+      m_Manager->EnsureLoaded(m_SelectedTrainIndex);
       auto &currTrain = trains[m_SelectedTrainIndex];
 
       if (ImGui::Button("Set Active", ImVec2(120, 0))) {
@@ -112,6 +134,7 @@ void EditorUI::Render() {
         if (m_Manager->GetActiveTrain() == &currTrain)
           m_Manager->SetActiveTrain(-1);
         m_SelectedTrainIndex = -1;
+        m_Manager->MarkDirty();
 
         ImGui::Columns(1);
         ImGui::End();
@@ -123,23 +146,36 @@ void EditorUI::Render() {
       // Train Metadata
       char nameBuf[256];
       strncpy(nameBuf, currTrain.Name.c_str(), sizeof(nameBuf));
-      if (ImGui::InputText("Train Name", nameBuf, sizeof(nameBuf)))
+      if (ImGui::InputText("Train Name", nameBuf, sizeof(nameBuf))) {
         currTrain.Name = nameBuf;
+        m_Manager->MarkDirty();
+      }
 
       char authorBuf[256];
       strncpy(authorBuf, currTrain.Author.c_str(), sizeof(authorBuf));
-      if (ImGui::InputText("Author", authorBuf, sizeof(authorBuf)))
+      if (ImGui::InputText("Author", authorBuf, sizeof(authorBuf))) {
         currTrain.Author = authorBuf;
+        m_Manager->MarkDirty();
+      }
 
       const char *trainTypes[] = {"Boss Train", "Farm Train", "Mixed"};
       int currentType = static_cast<int>(currTrain.Type);
       if (ImGui::Combo("Train Type", &currentType, trainTypes,
                        IM_ARRAYSIZE(trainTypes))) {
         currTrain.Type = static_cast<TrainType>(currentType);
+        m_Manager->MarkDirty();
       }
 
       ImGui::Separator();
       ImGui::TextColored(ImVec4(180 / 255.0f, 220 / 255.0f, 255 / 255.0f, 1.0f), "Steps:");
+      if (!currTrain.StepsLoaded) {
+        // Editing steps that are not in memory would lose the edits
+        ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f),
+                           "This train's steps could not be read from disk.");
+        ImGui::Columns(1);
+        ImGui::End();
+        return;
+      }
 
       // Step List
       ImGui::PushStyleColor(ImGuiCol_ChildBg, IM_COL32(24, 40, 65, 255));
@@ -186,6 +222,7 @@ void EditorUI::Render() {
           m_SelectedStepIndex = moveTo;
         else if (m_SelectedStepIndex == moveTo)
           m_SelectedStepIndex = moveFrom;
+        m_Manager->MarkDirty();
       }
       ImGui::EndChild();
       ImGui::PopStyleColor();
@@ -195,12 +232,14 @@ void EditorUI::Render() {
         step.Title = "New Step";
         currTrain.Steps.push_back(step);
         m_SelectedStepIndex = currTrain.Steps.size() - 1;
+        m_Manager->MarkDirty();
       }
       ImGui::SameLine();
       if (m_SelectedStepIndex >= 0 &&
           ImGui::Button("Delete Step", ImVec2(120, 0))) {
         currTrain.Steps.erase(currTrain.Steps.begin() + m_SelectedStepIndex);
         m_SelectedStepIndex = -1;
+        m_Manager->MarkDirty();
       }
 
       ImGui::Separator();
@@ -213,37 +252,65 @@ void EditorUI::Render() {
 
         char titleBuf[256];
         strncpy(titleBuf, currStep.Title.c_str(), sizeof(titleBuf));
-        if (ImGui::InputText("Title", titleBuf, sizeof(titleBuf)))
+        if (ImGui::InputText("Title", titleBuf, sizeof(titleBuf))) {
           currStep.Title = titleBuf;
+          m_Manager->MarkDirty();
+        }
 
         char descBuf[512];
         strncpy(descBuf, currStep.Description.c_str(), sizeof(descBuf));
-        if (ImGui::InputTextMultiline("Description", descBuf, sizeof(descBuf)))
+        if (ImGui::InputTextMultiline("Description", descBuf, sizeof(descBuf))) {
           currStep.Description = descBuf;
+          m_Manager->MarkDirty();
+        }
 
         char wpBuf[128];
         strncpy(wpBuf, currStep.WaypointCode.c_str(), sizeof(wpBuf));
-        if (ImGui::InputText("Waypoint Code", wpBuf, sizeof(wpBuf)))
+        if (ImGui::InputText("Waypoint Code", wpBuf, sizeof(wpBuf))) {
           currStep.WaypointCode = wpBuf;
+          m_Manager->MarkDirty();
+        }
 
         char sqBuf[512];
         strncpy(sqBuf, currStep.SquadMessage.c_str(), sizeof(sqBuf));
         if (ImGui::InputTextMultiline("Squad Message", sqBuf, sizeof(sqBuf),
-                                      ImVec2(-1, 60)))
+                                      ImVec2(-1, 60))) {
           currStep.SquadMessage = sqBuf;
+          m_Manager->MarkDirty();
+        }
+        if (m_Preview.GetSource() != currStep.SquadMessage)
+          m_Preview.Compile(currStep.SquadMessage);
+        if (m_Preview.HasPlaceholders()) {
+          m_Preview.Render(
+              MessageContext::At(currTrain, m_SelectedStepIndex, clock),
+              m_PreviewText);
+          ImGui::TextDisabled("Preview: %s", m_PreviewText.c_str());
+        }
+        ImGui::TextDisabled("(?)");
+        if (ImGui::IsItemHovered())
+          ImGui::SetTooltip("Placeholders, filled in when the message is sent:\n"
+                            "{title} {wp} {mechanics}  this step\n"
+                            "{next.title} {next.wp}  the step after it\n"
+                            "{eta}  time until this step spawns\n"
+                            "{step} {total} {train}\n"
+                            "{{ for a literal brace");
+        DrawChatLineCount(currStep.SquadMessage);
 
         ImGui::Spacing();
         ImGui::TextDisabled("Mechanics / Group Assignments:");
         char mechBuf[1024];
         strncpy(mechBuf, currStep.Mechanics.c_str(), sizeof(mechBuf));
         if (ImGui::InputTextMultiline("##Mechanics", mechBuf, sizeof(mechBuf),
-                                      ImVec2(-1, 80)))
+                                      ImVec2(-1, 80))) {
           currStep.Mechanics = mechBuf;
+          m_Manager->MarkDirty();
+        }
 
         ImGui::SameLine();
         if (ImGui::Button("Copy Mechanics")) {
           ImGui::SetClipboardText(currStep.Mechanics.c_str());
         }
+        DrawChatLineCount(currStep.Mechanics);
 
         ImGui::Spacing();
         ImGui::TextDisabled("Custom Messages for this Step:");
@@ -254,6 +321,7 @@ void EditorUI::Render() {
           ImGui::PushID(m);
           if (ImGui::SmallButton("X")) {
             currStep.CustomMessages.erase(currStep.CustomMessages.begin() + m);
+            m_Manager->MarkDirty();
             ImGui::PopID();
             ImGui::EndChild();
             ImGui::PopStyleColor();
@@ -283,6 +351,7 @@ void EditorUI::Render() {
           if (ImGui::Button("Add")) {
             if (strlen(newText) > 0) { // Require at least some text
               currStep.CustomMessages.push_back({newTitle, newText});
+              m_Manager->MarkDirty();
               memset(newTitle, 0, sizeof(newTitle));
               memset(newText, 0, sizeof(newText));
               ImGui::CloseCurrentPopup();
@@ -296,9 +365,71 @@ void EditorUI::Render() {
           }
           ImGui::EndPopup();
         }
+
+        DrawCallouts(currStep);
       }
     }
     ImGui::Columns(1);
   }
   ImGui::End();
 }
+
+void EditorUI::DrawChatLineCount(const std::string &text) {
+  ChatSplitter::Split(text, ChatQueue::MaxTextLength(true), m_ChatLines);
+  if (m_ChatLines.size() > 1)
+    ImGui::TextDisabled("Broadcast as %zu chat lines", m_ChatLines.size());
+}
+
+void EditorUI::DrawCallouts(TrainStep &step) {
+  static const char *kContents[] = {"WP + Msg", "Msg", "Mechanics",
+                                    "Custom message"};
+
+  ImGui::Spacing();
+  ImGui::TextDisabled("Timed Callouts (sent while the train is active):");
+  if (step.SpawnMinuteUTC < 0 && !step.Callouts.empty())
+    ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.2f, 1.0f),
+                       "This step has no spawn time; its callouts never fire.");
+
+  for (int i = 0; i < (int)step.Callouts.size(); ++i) {
+    Callout &callout = step.Callouts[i];
+    ImGui::PushID(i);
+    if (ImGui::SmallButton("X")) {
+      step.Callouts.erase(step.Callouts.begin() + i);
+      m_Manager->MarkDirty();
+      ImGui::PopID();
+      return;
+    }
+    ImGui::SameLine();
+    int offset = callout.OffsetSeconds;
+    int absOffset = offset < 0 ? -offset : offset;
+    ImGui::Text("T%c%dm %02ds", offset < 0 ? '-' : '+', absOffset / 60,
+                absOffset % 60);
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(90.0f);
+    if (ImGui::InputInt("s##Offset", &callout.OffsetSeconds, 30, 60))
+      m_Manager->MarkDirty();
+    ImGui::SameLine();
+    int content = static_cast<int>(callout.Content);
+    ImGui::SetNextItemWidth(130.0f);
+    if (ImGui::Combo("##Content", &content, kContents,
+                     IM_ARRAYSIZE(kContents))) {
+      callout.Content = static_cast<CalloutContent>(content);
+      m_Manager->MarkDirty();
+    }
+    if (callout.Content == CalloutContent::CustomMessage) {
+      ImGui::SameLine();
+      int number = callout.CustomMessageIndex + 1;
+      ImGui::SetNextItemWidth(80.0f);
+      if (ImGui::InputInt("##Custom", &number)) {
+        callout.CustomMessageIndex = number < 1 ? 0 : number - 1;
+        m_Manager->MarkDirty();
+      }
+    }
+    ImGui::PopID();
+  }
+
+  if (ImGui::Button("Add Callout")) {
+    step.Callouts.push_back(Callout());
+    m_Manager->MarkDirty();
+  }
+}
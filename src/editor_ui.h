@@ -1,7 +1,10 @@
 #pragma once
 #include "nexus/Nexus.h"
 
+#include "message_template.h"
 #include "train_manager.h"
+#include <string_view>
+#include <vector>
 
 class EventUI; // Forward declaration
 
@@ -10,20 +13,34 @@ public:
   EditorUI(AddonAPI_t *api, TrainManager *manager, EventUI *eventUI);
   ~EditorUI() = default;
 
-  void Render();
+  void Render(const FrameClock &clock);
 
   bool IsVisible() const { return m_Visible; }
   void Show() { m_Visible = true; }
   void Hide() { m_Visible = false; }
   void Toggle() { m_Visible = !m_Visible; }
+  void Select(int trainIndex, int stepIndex = -1) {
+    m_SelectedTrainIndex = trainIndex;
+    m_SelectedStepIndex = stepIndex;
+  }
 
 private:
+  // Notes how many chat lines a broadcast of `text` takes, if more than one
+  void DrawChatLineCount(const std::string &text);
+  // Offset, content and removal of each timed callout of `step`
+  void DrawCallouts(TrainStep &step);
+
   TrainManager *m_Manager;
   EventUI *m_EventUI;
   AddonAPI_t *m_API = nullptr;
-  Texture_t *m_Icon = nullptr;
   bool m_Visible = false;
 
   int m_SelectedTrainIndex = -1;
   int m_SelectedStepIndex = -1;
+  std::string m_ImportError; // Shown under the paste button until it works
+  bool m_SaveFailed = false;  // Outcome of the last explicit save
+  std::vector<std::string_view> m_ChatLines; // Reused by DrawChatLineCount
+  // Squad message of the selected step, recompiled when its text changes
+  MessageTemplate m_Preview;
+  std::string m_PreviewText;
 };
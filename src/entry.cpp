@@ -1,3 +1,6 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
 #include <fstream>
 #include <string>
 
@@ -5,12 +8,15 @@
 #include "mumble/Mumble.h"
 #include "nexus/Nexus.h"
 
-#include "base64.h"
+#include "addon_icon.h"
 #include "editor_ui.h"
 #include "event_catalog.h"
 #include "event_ui.h"
+#include "frame_clock.h"
 #include "overlay_ui.h"
-#include "premium_icon.h"
+#include "platform.h"
+#include "profiler.h"
+#include "spawn_alerts.h"
 #include "train_manager.h"
 
 // Prototypes
@@ -31,6 +37,16 @@ EventCatalog *g_Catalog = nullptr;
 EditorUI *g_EditorUI = nullptr;
 OverlayUI *g_OverlayUI = nullptr;
 EventUI *g_EventUI = nullptr;
+SpawnAlerts *g_Alerts = nullptr;
+
+// Deferred startup. AddonLoad only creates the objects, which are cheap, and
+// registers with Nexus; reading the train library and fetching the event
+// schedule wait until a window needs them or kStartupDelay after the first
+// frame, so they stay out of the game's loading screen.
+static const auto kStartupDelay = std::chrono::seconds(3);
+static bool g_LibraryLoaded = false;
+static bool g_CatalogStarted = false;
+static std::chrono::steady_clock::time_point g_FirstFrame; // Zero until then
 
 static void NexusLog(ELogLevel aLevel, const char *aChannel,
                      const char *aStr) {
@@ -59,6 +75,124 @@ static std::string GetAddonDirectory(AddonAPI_t *api,
   return std::string();
 }
 
+static double MillisecondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+static void EnsureLibraryLoaded() {
+  if (g_LibraryLoaded || !g_Manager)
+    return;
+  g_LibraryLoaded = true;
+  auto start = std::chrono::steady_clock::now();
+  g_Manager->LoadTrains();
+  if (g_Alerts)
+    g_Alerts->Load();
+  char msg[128];
+  snprintf(msg, sizeof(msg), "Train library loaded (%zu trains) in %.1f ms.",
+           g_Manager->GetTrains().size(), MillisecondsSince(start));
+  NexusLog(LOGL_INFO, "TrainCommander", msg);
+}
+
+static void EnsureCatalogStarted() {
+  if (g_CatalogStarted || !g_Catalog)
+    return;
+  g_CatalogStarted = true;
+  g_Catalog->FetchEventsAsync();
+}
+
+static void DrawAlertSettings() {
+  SpawnAlerts::Settings settings = g_Alerts->GetSettings();
+  bool changed = false;
+
+  changed |= ImGui::Checkbox("Alert before each step of the active train",
+                             &settings.TrainSteps);
+
+  // Edited as text; applied when editing ends, if it holds any number.
+  // Rewritten from the settings whenever they change (loaded, or clamped,
+  // sorted and deduplicated by SetSettings), unless it is being typed in.
+  static char s_Leads[64] = "";
+  static uint64_t s_LeadsRevision = 0;
+  static bool s_LeadsActive = false;
+  if (s_LeadsRevision != g_Alerts->GetSettingsRevision() && !s_LeadsActive) {
+    std::string text;
+    for (int lead : settings.LeadMinutes)
+      text += (text.empty() ? "" : ", ") + std::to_string(lead);
+    snprintf(s_Leads, sizeof(s_Leads), "%s", text.c_str());
+    s_LeadsRevision = g_Alerts->GetSettingsRevision();
+  }
+  ImGui::InputText("Minutes before spawn", s_Leads, sizeof(s_Leads));
+  s_LeadsActive = ImGui::IsItemActive();
+  if (ImGui::IsItemDeactivatedAfterEdit()) {
+    std::vector<int> leads;
+    for (const char *p = s_Leads; *p;) {
+      char *end = nullptr;
+      long value = strtol(p, &end, 10);
+      if (end == p) {
+        p++;
+        continue;
+      }
+      leads.push_back(static_cast<int>(value));
+      p = end;
+    }
+    if (!leads.empty()) {
+      settings.LeadMinutes = leads;
+      changed = true;
+    }
+  }
+
+  ImGui::TextDisabled("Right-click an event in the Event Catalog to pin it.");
+  for (size_t i = 0; i < settings.PinnedEvents.size(); ++i) {
+    ImGui::PushID(static_cast<int>(i));
+    if (ImGui::SmallButton("X")) {
+      settings.PinnedEvents.erase(settings.PinnedEvents.begin() + i);
+      changed = true;
+      ImGui::PopID();
+      break;
+    }
+    ImGui::SameLine();
+    ImGui::Text("%s", settings.PinnedEvents[i].c_str());
+    ImGui::PopID();
+  }
+
+  if (changed)
+    g_Alerts->SetSettings(std::move(settings));
+}
+
+#if TC_ENABLE_PROFILER
+static void DrawProfilerStats() {
+  ImGuiTableFlags flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg;
+  if (!ImGui::BeginTable("ProfilerStats", 6, flags))
+    return;
+
+  ImGui::TableSetupColumn("Section");
+  ImGui::TableSetupColumn("Samples");
+  ImGui::TableSetupColumn("p50 (ms)");
+  ImGui::TableSetupColumn("p95 (ms)");
+  ImGui::TableSetupColumn("p99 (ms)");
+  ImGui::TableSetupColumn("Max (ms)");
+  ImGui::TableHeadersRow();
+
+  for (const auto &s : Profiler::GetStats()) {
+    ImGui::TableNextRow();
+    ImGui::TableSetColumnIndex(0);
+    ImGui::Text("%s", s.Name);
+    ImGui::TableSetColumnIndex(1);
+    ImGui::Text("%llu", static_cast<unsigned long long>(s.Samples));
+    ImGui::TableSetColumnIndex(2);
+    ImGui::Text("%.3f", s.P50);
+    ImGui::TableSetColumnIndex(3);
+    ImGui::Text("%.3f", s.P95);
+    ImGui::TableSetColumnIndex(4);
+    ImGui::Text("%.3f", s.P99);
+    ImGui::TableSetColumnIndex(5);
+    ImGui::Text("%.3f", s.Max);
+  }
+  ImGui::EndTable();
+}
+#endif
+
 // Main entry point
 BOOL APIENTRY DllMain(HMODULE hModule, DWORD ul_reason_for_call,
                       LPVOID lpReserved) {
@@ -101,6 +235,7 @@ void AddonLoad(AddonAPI_t *aApi) {
   APIDefs = aApi; // store the api
   if (!APIDefs)
     return;
+  auto loadStart = std::chrono::steady_clock::now();
 
   if (APIDefs->ImguiContext)
     ImGui::SetCurrentContext((ImGuiContext *)APIDefs->ImguiContext);
@@ -123,12 +258,14 @@ void AddonLoad(AddonAPI_t *aApi) {
     addonDir = "TrainCommander";
   }
 
+  // The library is read and the schedule fetched later; see EnsureLibraryLoaded
   g_Manager = new TrainManager(addonDir);
-  g_Manager->LoadTrains();
-
-  g_Catalog = new EventCatalog(addonDir, APIDefs);
+  g_Catalog = new EventCatalog(addonDir, [](const char *msg) {
+    NexusLog(LOGL_INFO, "TrainCommander", msg);
+  });
 
-  g_EventUI = new EventUI(APIDefs, g_Manager, g_Catalog);
+  g_Alerts = new SpawnAlerts(addonDir);
+  g_EventUI = new EventUI(APIDefs, g_Manager, g_Catalog, g_Alerts);
   g_EditorUI = new EditorUI(APIDefs, g_Manager, g_EventUI);
   g_OverlayUI = new OverlayUI(APIDefs, g_Manager, g_Catalog);
 
@@ -147,33 +284,17 @@ void AddonLoad(AddonAPI_t *aApi) {
              "Input binds unavailable in this Nexus API version.");
   }
 
-  // Setup QuickAccess Icon
-  const char *iconId = "TC_ICON";
-  std::string rawIcon = Base64::Decode(PREMIUM_ICON_B64);
-  if (APIDefs->Textures_GetOrCreateFromMemory) {
-    APIDefs->Textures_GetOrCreateFromMemory(iconId, (void *)rawIcon.data(),
-                                            rawIcon.size());
-  }
-
   // Cleanup old file-based icon if it exists
-  std::string iconPath = addonDir + "\\icon.png";
-  if (GetFileAttributesA(iconPath.c_str()) != INVALID_FILE_ATTRIBUTES) {
-    DeleteFileA(iconPath.c_str());
-  }
-
-  // Load fallback memory texture
-  std::string base64RedPng = "iVBORw0KGgoAAAANSUhEUgAAAAEAAAABCAYAAAAfFcSJAAAAD"
-                             "UlEQVR42mP8z8BQDwAEhQGAhKmMIQAAAABJRU5ErkJggg==";
-  std::string rawRedPng = Base64::Decode(base64RedPng);
-  if (APIDefs->Textures_GetOrCreateFromMemory) {
-    APIDefs->Textures_GetOrCreateFromMemory(
-        "TC_ICON_RED", (void *)rawRedPng.data(), rawRedPng.size());
+  std::string iconPath = Platform::JoinPath(addonDir, "icon.png");
+  if (Platform::FileExists(iconPath)) {
+    Platform::RemoveFile(iconPath);
   }
 
-  // Register QuickAccess Button
+  // Register QuickAccess Button. Nexus resolves the icon by name when it
+  // draws the button; the texture itself is created on the first frame.
   if (APIDefs->QuickAccess_Add) {
-    APIDefs->QuickAccess_Add("TC_SHORTCUT", iconId, iconId, "KB_TRAIN_EDITOR",
-                             "Train Commander");
+    APIDefs->QuickAccess_Add("TC_SHORTCUT", AddonIcon::kId, AddonIcon::kId,
+                             "KB_TRAIN_EDITOR", "Train Commander");
   }
 
   // Register Renderer
@@ -185,7 +306,10 @@ void AddonLoad(AddonAPI_t *aApi) {
              "GUI_Register unavailable in this Nexus API version.");
   }
 
-  NexusLog(LOGL_INFO, "TrainCommander", "Addon loaded successfully.");
+  char msg[64];
+  snprintf(msg, sizeof(msg), "Addon loaded in %.2f ms.",
+           MillisecondsSince(loadStart));
+  NexusLog(LOGL_INFO, "TrainCommander", msg);
 }
 
 // Cleanup on unload
@@ -202,7 +326,9 @@ void AddonUnload() {
   }
 
   if (g_Manager) {
-    g_Manager->SaveTrains();
+    // Saving a library that was never read would overwrite it with nothing
+    if (g_LibraryLoaded)
+      g_Manager->SaveTrains();
     delete g_Manager;
     g_Manager = nullptr;
   }
@@ -227,26 +353,75 @@ void AddonUnload() {
     g_Catalog = nullptr;
   }
 
+  if (g_Alerts) {
+    delete g_Alerts;
+    g_Alerts = nullptr;
+  }
+
+  g_LibraryLoaded = false;
+  g_CatalogStarted = false;
+  g_FirstFrame = {};
+
   NexusLog(LOGL_INFO, "TrainCommander", "Addon unloaded.");
 }
 
 // Render loop
 void AddonRender() {
+  TC_PROFILE_SCOPE("AddonRender");
+
+  // Sample UTC once so every window works off the same "now"
+  FrameClock clock = FrameClock::Now();
+
+  // Open windows need their data now; otherwise start once the game is up
+  auto now = std::chrono::steady_clock::now();
+  if (g_FirstFrame == std::chrono::steady_clock::time_point())
+    g_FirstFrame = now;
+  bool startupDue = now - g_FirstFrame >= kStartupDelay;
+  bool eventsShown = g_EventUI && g_EventUI->IsVisible();
+  if (startupDue || eventsShown || (g_EditorUI && g_EditorUI->IsVisible()))
+    EnsureLibraryLoaded();
+  if (startupDue || eventsShown)
+    EnsureCatalogStarted();
+
+  if (g_Manager) {
+    g_Manager->Update(); // Debounced autosave
+  }
+
+  AddonIcon::Get(APIDefs); // For the QuickAccess button; cached once created
+
+  if (g_Alerts && g_LibraryLoaded) {
+    // Deadlines are only rebuilt when the train, catalog or settings change
+    static std::vector<std::string> s_Alerts;
+    g_Alerts->Sync(g_Manager->GetActiveTrain(), g_Manager->GetRevision(),
+                   g_CatalogStarted ? g_Catalog : nullptr, clock);
+    s_Alerts.clear();
+    g_Alerts->Update(clock, s_Alerts);
+    for (const std::string &alert : s_Alerts) {
+      if (APIDefs->GUI_SendAlert)
+        APIDefs->GUI_SendAlert(alert.c_str());
+    }
+  }
+
   if (g_EditorUI) {
-    g_EditorUI->Render();
+    TC_PROFILE_SCOPE("EditorUI::Render");
+    g_EditorUI->Render(clock);
   }
 
   if (g_OverlayUI) { // Let Overlay UI decide if it has something to show
-    g_OverlayUI->Render();
+    TC_PROFILE_SCOPE("OverlayUI::Render");
+    g_OverlayUI->Render(clock);
   }
 
   if (g_EventUI) {
-    g_EventUI->Render();
+    TC_PROFILE_SCOPE("EventUI::Render");
+    g_EventUI->Render(clock);
   }
 }
 
 // Addon options in Nexus menu
 void AddonOptions() {
+  EnsureLibraryLoaded(); // The storage format comes from the library index
+
   ImGui::Text("Train Commander Options");
   ImGui::Separator();
   if (ImGui::Button("Open Train Editor")) {
@@ -254,4 +429,52 @@ void AddonOptions() {
       g_EditorUI->Show();
     }
   }
+
+  if (g_Manager) {
+    // Binary formats are smaller and faster to load but not hand-editable
+    static const TrainFormat kStorageFormats[] = {
+        TrainFormat::PrettyJson, TrainFormat::Cbor, TrainFormat::MsgPack};
+    TrainFormat current = g_Manager->GetStorageFormat();
+    if (ImGui::BeginCombo("Library storage format",
+                          TrainCodec::FormatName(current))) {
+      for (TrainFormat format : kStorageFormats) {
+        if (ImGui::Selectable(TrainCodec::FormatName(format),
+                              format == current))
+          g_Manager->SetStorageFormat(format);
+      }
+      ImGui::EndCombo();
+    }
+  }
+
+  if (g_OverlayUI) {
+    // Fewer characters per frame keeps long broadcasts from spiking a frame
+    ChatQueue &chat = g_OverlayUI->GetChatQueue();
+    int charsPerFrame = chat.GetCharsPerFrame();
+    if (ImGui::SliderInt("Chat characters per frame", &charsPerFrame, 1, 64))
+      chat.SetCharsPerFrame(charsPerFrame);
+  }
+
+  if (g_Alerts && ImGui::CollapsingHeader("Spawn Alerts")) {
+    DrawAlertSettings();
+  }
+
+#if TC_ENABLE_PROFILER
+  ImGui::Separator();
+  if (ImGui::CollapsingHeader("Frame Cost (debug build)")) {
+    DrawProfilerStats();
+    if (ImGui::Button("Export CSV") && g_Manager) {
+      std::string csvPath =
+          Platform::JoinPath(g_Manager->GetAddonDir(), "profile.csv");
+      if (Profiler::ExportCsv(csvPath))
+        NexusLog(LOGL_INFO, "TrainCommander",
+                 ("Profile exported to " + csvPath).c_str());
+      else
+        NexusLog(LOGL_WARNING, "TrainCommander", "Profile export failed.");
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Reset")) {
+      Profiler::Reset();
+    }
+  }
+#endif
 }
@@ -1,24 +1,27 @@
 #define _CRT_SECURE_NO_WARNINGS
 #include "event_catalog.h"
+#include "profiler.h"
 #include <algorithm>
 #include <cctype>
-#include <chrono>
-#include <ctime>
+#include <cstdio>
 #include <fstream>
 #include <map>
 #include <string>
-#include <windows.h>
-#include <wininet.h>
+#include <utility>
 
-#pragma comment(lib, "wininet.lib")
+#include "platform.h"
 
 using json = nlohmann::json;
 
-EventCatalog::EventCatalog(const std::string &addonDir, AddonAPI_t *api)
-    : m_AddonDir(addonDir), m_NexusApi(api) {
-  FetchEventsAsync();
+// Minute of the UTC day for a unix timestamp (thread-safe, no gmtime)
+static int UtcMinuteOfDay(int64_t utcSeconds) {
+  int64_t secondsOfDay = ((utcSeconds % 86400) + 86400) % 86400;
+  return static_cast<int>(secondsOfDay / 60);
 }
 
+EventCatalog::EventCatalog(const std::string &addonDir, LogFn log)
+    : m_AddonDir(addonDir), m_Log(std::move(log)) {}
+
 EventCatalog::~EventCatalog() {
   if (m_FetchThread.joinable()) {
     m_FetchThread.join();
@@ -27,47 +30,30 @@ EventCatalog::~EventCatalog() {
 
 void EventCatalog::PopulateEvents() {}
 
+void EventCatalog::SetEvents(std::vector<EventDefinition> events) {
+  std::lock_guard<std::mutex> lock(m_EventsMutex);
+  m_Events = std::move(events);
+  m_Revision++;
+}
+
 void EventCatalog::FetchEventsAsync() {
   if (m_IsFetching)
     return;
   m_IsFetching = true;
   m_FetchThread = std::thread([this]() {
-    HINTERNET hInternet = InternetOpenA(
-        "TrainCommander/1.1", INTERNET_OPEN_TYPE_PRECONFIG, NULL, NULL, 0);
-    if (!hInternet) {
-      m_IsFetching = false;
-      return;
-    }
-
-    HINTERNET hConnect = InternetOpenUrlA(
-        hInternet,
-        "https://raw.githubusercontent.com/qjv/event-timers/main/"
-        "event_tracks.json",
-        NULL, 0, INTERNET_FLAG_RELOAD | INTERNET_FLAG_SECURE, 0);
-
-    if (!hConnect) {
-      InternetCloseHandle(hInternet);
+    std::string responseData;
+    if (!Platform::HttpGet("https://raw.githubusercontent.com/qjv/event-timers/"
+                           "main/event_tracks.json",
+                           "TrainCommander/1.1", responseData)) {
       m_IsFetching = false;
       return;
     }
 
-    std::string responseData;
-    char buffer[4096];
-    DWORD bytesRead = 0;
-    while (InternetReadFile(hConnect, buffer, sizeof(buffer), &bytesRead) &&
-           bytesRead > 0) {
-      responseData.append(buffer, bytesRead);
-    }
-
-    InternetCloseHandle(hConnect);
-
-    InternetCloseHandle(hInternet);
-
-    if (m_NexusApi) {
+    if (m_Log) {
       char logBuf[256];
       snprintf(logBuf, sizeof(logBuf),
                "Fetched event_tracks (%zu bytes)", responseData.size());
-      m_NexusApi->Log(ELogLevel::LOGL_INFO, "TrainCommander", logBuf);
+      m_Log(logBuf);
     }
 
     if (!responseData.empty()) {
@@ -84,11 +70,7 @@ void EventCatalog::ParseWikiJson(const std::string &jsonData) {
     std::vector<EventDefinition> newEvents;
 
     // Calc UTC-3 midnight reference
-    auto nowChrono = std::chrono::system_clock::now();
-    int64_t current_utc_seconds =
-        std::chrono::duration_cast<std::chrono::seconds>(
-            nowChrono.time_since_epoch())
-            .count();
+    int64_t current_utc_seconds = FrameClock::Now().EpochSeconds;
 
     int64_t seconds_per_day = 24 * 60 * 60;
     int64_t timezone_offset = -3 * 60 * 60; // UTC-3
@@ -105,12 +87,9 @@ void EventCatalog::ParseWikiJson(const std::string &jsonData) {
         current_utc_seconds - seconds_since_local_midnight;
 
     // Now convert the actual local UTC-3 midnight back into a "minute of the
-    // UTC day" to map our 0-1440 array directly against `tm_hour * 60 + tm_min`
-    time_t midnight_time = (time_t)local_midnight_utc_seconds;
-    struct tm *tm_utc_midnight = gmtime(&midnight_time);
-
+    // UTC day" to map our 0-1440 array directly against the frame clock
     int midnight_minute_of_utc_day =
-        tm_utc_midnight->tm_hour * 60 + tm_utc_midnight->tm_min;
+        UtcMinuteOfDay(local_midnight_utc_seconds);
 
     if (raw.contains("categories")) {
       for (const auto &cat : raw["categories"]) {
@@ -138,10 +117,7 @@ void EventCatalog::ParseWikiJson(const std::string &jsonData) {
                 reference_time + (cycles_elapsed * cycle_duration);
 
             // Mapping cycle to UTC day (0-1440)
-            time_t cycle_time = (time_t)current_cycle_start_utc;
-            struct tm *tm_utc_cycle = gmtime(&cycle_time);
-            baseTimeUtcMinute =
-                tm_utc_cycle->tm_hour * 60 + tm_utc_cycle->tm_min;
+            baseTimeUtcMinute = UtcMinuteOfDay(current_cycle_start_utc);
           }
 
           if (!track.contains("schedules"))
@@ -161,7 +137,6 @@ void EventCatalog::ParseWikiJson(const std::string &jsonData) {
             def.Name = eventName;
             def.Map = catName; // Group by category name (e.g. Base Game)
             def.WaypointCode = wp;
-            def.DefaultSquadMessage = "Next up: " + eventName + " " + wp;
 
 
             std::vector<std::pair<int, int>> timeDurations;
@@ -216,25 +191,30 @@ void EventCatalog::ParseWikiJson(const std::string &jsonData) {
       }
     }
 
-    std::lock_guard<std::mutex> lock(m_EventsMutex);
-    m_Events = newEvents;
+    SetEvents(std::move(newEvents));
   } catch (const std::exception &) {
     // Log exception if needed
   }
 }
 
-std::vector<UpcomingEvent> EventCatalog::GetUpcomingEvents(int limit) {
-  std::vector<UpcomingEvent> upcoming;
+std::vector<int> EventCatalog::GetSpawnMinutes(const std::string &name) const {
+  std::vector<int> minutes;
+  std::lock_guard<std::mutex> lock(m_EventsMutex);
+  for (const auto &ev : m_Events) {
+    if (ev.Name == name)
+      minutes.insert(minutes.end(), ev.SpawnTimesUTC.begin(),
+                     ev.SpawnTimesUTC.end());
+  }
+  return minutes;
+}
 
-  auto nowChrono = std::chrono::system_clock::now();
-  time_t now = std::chrono::system_clock::to_time_t(nowChrono);
-  struct tm *tm_utc = gmtime(&now);
+std::vector<UpcomingEvent>
+EventCatalog::GetUpcomingEvents(const FrameClock &clock, int limit) {
+  TC_PROFILE_SCOPE("EventCatalog::GetUpcomingEvents");
+  std::vector<UpcomingEvent> upcoming;
 
-  int currentMinuteOfDay = tm_utc->tm_hour * 60 + tm_utc->tm_min;
-  auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-                nowChrono.time_since_epoch()) %
-            1000;
-  float fractionalMinute = tm_utc->tm_sec / 60.0f + ms.count() / 60000.0f;
+  int currentMinuteOfDay = clock.MinuteOfDay;
+  float fractionalMinute = clock.FractionalMinute;
 
   std::lock_guard<std::mutex> lock(m_EventsMutex);
 
@@ -285,18 +265,13 @@ std::vector<UpcomingEvent> EventCatalog::GetUpcomingEvents(int limit) {
 }
 
 std::vector<UpcomingEvent>
-EventCatalog::GetEventsInRange(int minMinutesOffset, int maxMinutesOffset) {
+EventCatalog::GetEventsInRange(const FrameClock &clock, int minMinutesOffset,
+                               int maxMinutesOffset) {
+  TC_PROFILE_SCOPE("EventCatalog::GetEventsInRange");
   std::vector<UpcomingEvent> upcoming;
 
-  auto nowChrono = std::chrono::system_clock::now();
-  time_t now = std::chrono::system_clock::to_time_t(nowChrono);
-  struct tm *tm_utc = gmtime(&now);
-
-  int currentMinuteOfDay = tm_utc->tm_hour * 60 + tm_utc->tm_min;
-  auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-                nowChrono.time_since_epoch()) %
-            1000;
-  float fractionalMinute = tm_utc->tm_sec / 60.0f + ms.count() / 60000.0f;
+  int currentMinuteOfDay = clock.MinuteOfDay;
+  float fractionalMinute = clock.FractionalMinute;
 
   std::lock_guard<std::mutex> lock(m_EventsMutex);
 
@@ -1,7 +1,10 @@
 #pragma once
 
-#include "nexus/Nexus.h"
+#include "frame_clock.h"
 #include "nlohmann_json.hpp"
+#include <atomic>
+#include <cstdint>
+#include <functional>
 #include <mutex>
 #include <string>
 #include <thread>
@@ -12,7 +15,6 @@ struct EventDefinition {
   std::string Name;
   std::string Map;
   std::string WaypointCode;
-  std::string DefaultSquadMessage;
   std::vector<int> SpawnTimesUTC; // Minute of the day (0-1439)
   std::vector<int> DurationsUTC;  // Corresponding durations
 };
@@ -26,25 +28,43 @@ struct UpcomingEvent {
 
 class EventCatalog {
 public:
-  EventCatalog(const std::string &addonDir, AddonAPI_t *api);
+  using LogFn = std::function<void(const char *)>;
+
+  EventCatalog(const std::string &addonDir, LogFn log = LogFn());
   ~EventCatalog();
 
   void PopulateEvents();
+  // Downloads the schedule on a background thread. Not started by the
+  // constructor; the addon calls it once the event window needs data.
   void FetchEventsAsync();
 
-  std::vector<UpcomingEvent> GetUpcomingEvents(int limit = 0);
-  std::vector<UpcomingEvent> GetEventsInRange(int minMinutesOffset,
+  // Publishes a new event snapshot and bumps the revision
+  void SetEvents(std::vector<EventDefinition> events);
+
+  std::vector<UpcomingEvent> GetUpcomingEvents(const FrameClock &clock,
+                                               int limit = 0);
+  std::vector<UpcomingEvent> GetEventsInRange(const FrameClock &clock,
+                                              int minMinutesOffset,
                                               int maxMinutesOffset);
 
+  // Spawn minutes (UTC) of every event called `name`; names can repeat
+  // across maps
+  std::vector<int> GetSpawnMinutes(const std::string &name) const;
+
   bool IsFetching() const { return m_IsFetching; }
 
+  // Bumped every time a new event snapshot is published; lets views cache
+  // derived layouts until the schedule actually changes.
+  uint64_t GetRevision() const { return m_Revision.load(); }
+
 private:
   void ParseWikiJson(const std::string &jsonData);
 
   std::string m_AddonDir;
-  AddonAPI_t *m_NexusApi;
+  LogFn m_Log;
   std::vector<EventDefinition> m_Events;
   mutable std::mutex m_EventsMutex;
+  std::atomic<uint64_t> m_Revision{0};
   bool m_IsFetching = false;
   std::thread m_FetchThread;
 };
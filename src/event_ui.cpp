@@ -1,9 +1,8 @@
 #include "event_ui.h"
+#include "addon_icon.h"
 #include "imgui/imgui.h"
 #include <algorithm>
-#include <chrono>
 #include <cmath>
-#include <ctime>
 #include <map>
 #include <string>
 #include <vector>
@@ -56,20 +55,73 @@ ImU32 GetDistinctColor(const std::string &category, int index) {
   return baseColor;
 }
 
-EventUI::EventUI(AddonAPI_t *api, TrainManager *manager, EventCatalog *catalog)
-    : m_API(api), m_Manager(manager), m_Catalog(catalog) {
-  if (m_API && m_API->Textures_Get) {
-    m_Icon = m_API->Textures_Get("TC_ICON");
+EventUI::EventUI(AddonAPI_t *api, TrainManager *manager, EventCatalog *catalog,
+                 SpawnAlerts *alerts)
+    : m_API(api), m_Manager(manager), m_Catalog(catalog), m_Alerts(alerts) {}
+
+void EventUI::RebuildTimeline(const FrameClock &clock, int minOffset,
+                              int maxOffset) {
+  auto upcomingEvents =
+      m_Catalog->GetEventsInRange(clock, minOffset, maxOffset);
+
+  std::map<std::string, std::vector<UpcomingEvent>> groupedEvents;
+  for (const auto &ev : upcomingEvents) {
+    groupedEvents[ev.Definition.Map].push_back(ev);
+  }
+
+  std::vector<std::string> order = {
+      "Day and night",   "World bosses",           "Hard world bosses",
+      "Heart of Thorns", "Path of Fire",           "Icebrood Saga",
+      "End of Dragons",  "Secrets of the Obscure", "Janthir Wilds"};
+
+  for (const auto &pair : groupedEvents) {
+    if (std::find(order.begin(), order.end(), pair.first) == order.end()) {
+      order.push_back(pair.first);
+    }
+  }
+
+  m_Timeline.clear();
+  for (const auto &cat : order) {
+    auto it = groupedEvents.find(cat);
+    if (it == groupedEvents.end())
+      continue;
+
+    TimelineRow row;
+    row.Category = cat;
+
+    // Greedy interval colouring: events come sorted by start, so first-fit
+    // over the lane end times uses the minimum number of lanes.
+    std::vector<int> laneEnds;
+    for (const auto &ev : it->second) {
+      int start = ev.MinutesUntilSpawn;
+      int end = start + (std::max)(ev.DurationMinutes, 1);
+
+      int lane = 0;
+      while (lane < static_cast<int>(laneEnds.size()) && laneEnds[lane] > start)
+        lane++;
+      if (lane == static_cast<int>(laneEnds.size()))
+        laneEnds.push_back(end);
+      else
+        laneEnds[lane] = end;
+
+      TimelineBlock block;
+      block.Event = ev;
+      block.Lane = lane;
+      block.NameId = m_Labels.Intern(ev.Definition.Name);
+      row.Blocks.push_back(block);
+    }
+    row.LaneCount = (std::max)(1, static_cast<int>(laneEnds.size()));
+    m_Timeline.push_back(row);
   }
 }
 
-void EventUI::Render() {
+void EventUI::Render(const FrameClock &clock) {
   if (!m_Visible || !m_Manager || !m_Catalog)
     return;
 
   ImGui::SetNextWindowSize(ImVec2(1000, 600), ImGuiCond_FirstUseEver);
   if (ImGui::Begin("Event Catalog", &m_Visible)) {
-    if (m_Icon) {
+    if (Texture_t *icon = AddonIcon::Get(m_API)) {
       float iconSize = m_IconHovered ? 32.0f : 24.0f;
       float offset = m_IconHovered ? -4.0f : 0.0f;
 
@@ -80,7 +132,7 @@ void EventUI::Render() {
 
       ImVec4 tint =
           m_IconHovered ? ImVec4(1.2f, 1.2f, 1.2f, 1.0f) : ImVec4(1, 1, 1, 1);
-      ImGui::ImageButton(m_Icon->Resource, ImVec2(iconSize, iconSize),
+      ImGui::ImageButton(icon->Resource, ImVec2(iconSize, iconSize),
                          ImVec2(0, 0), ImVec2(1, 1), 0, ImVec4(0, 0, 0, 0),
                          tint);
       m_IconHovered = ImGui::IsItemHovered();
@@ -93,15 +145,14 @@ void EventUI::Render() {
     ImGui::TextColored(ImVec4(190 / 255.0f, 210 / 255.0f, 255 / 255.0f, 180 / 255.0f), "Hover events to see more info and click to append to the active train.");
     ImGui::Separator();
 
-    if (m_ShowNoActiveTrainWarning) {
+    if (m_Warning) {
       ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 0.3f, 0.3f, 1.0f));
-      ImGui::Text(
-          "(!) No active train selected. Go to Editor and click 'Set Active'.");
+      ImGui::Text("%s", m_Warning);
       ImGui::PopStyleColor();
 
       m_WarningTimer -= ImGui::GetIO().DeltaTime;
       if (m_WarningTimer <= 0)
-        m_ShowNoActiveTrainWarning = false;
+        m_Warning = nullptr;
     }
 
     if (m_Catalog->IsFetching()) {
@@ -109,31 +160,22 @@ void EventUI::Render() {
     } else {
       int minOffset = -15;
       int maxOffset = 120;
-      auto upcomingEvents = m_Catalog->GetEventsInRange(minOffset, maxOffset);
 
-      std::map<std::string, std::vector<UpcomingEvent>> groupedEvents;
-      for (const auto &ev : upcomingEvents) {
-        groupedEvents[ev.Definition.Map].push_back(ev);
+      float fractionalMinute = clock.FractionalMinute;
+      uint64_t revision = m_Catalog->GetRevision();
+      if (revision != m_TimelineRevision ||
+          clock.MinuteOfDay != m_TimelineMinute) {
+        RebuildTimeline(clock, minOffset, maxOffset);
+        m_TimelineRevision = revision;
+        m_TimelineMinute = clock.MinuteOfDay;
       }
 
-      std::vector<std::string> order = {
-          "Day and night",   "World bosses",           "Hard world bosses",
-          "Heart of Thorns", "Path of Fire",           "Icebrood Saga",
-          "End of Dragons",  "Secrets of the Obscure", "Janthir Wilds"};
-
-      for (const auto &pair : groupedEvents) {
-        if (std::find(order.begin(), order.end(), pair.first) == order.end()) {
-          order.push_back(pair.first);
-        }
-      }
-
-
       float availableWidth = ImGui::GetContentRegionAvail().x - 190.0f;
       float pixelsPerMinute =
           (std::max)(6.0f, availableWidth /
                                static_cast<float>(maxOffset - minOffset));
       float timelineWidth = (maxOffset - minOffset) * pixelsPerMinute;
-      float rowHeight = 35.0f;
+      float laneHeight = 31.0f;
 
       ImGuiTableFlags flags = ImGuiTableFlags_BordersInnerV |
                               ImGuiTableFlags_ScrollX |
@@ -167,9 +209,9 @@ void EventUI::Render() {
                           ImVec2(headerPos.x + nowX, headerPos.y + 1000.0f),
                           IM_COL32(255, 50, 50, 200), 2.0f);
 
-        for (const auto &cat : order) {
-          if (groupedEvents.find(cat) == groupedEvents.end())
-            continue;
+        for (const auto &row : m_Timeline) {
+          const std::string &cat = row.Category;
+          float rowHeight = row.LaneCount * laneHeight + 4.0f;
 
           ImGui::TableNextRow(ImGuiTableRowFlags_None, rowHeight);
           ImGui::TableSetColumnIndex(0);
@@ -189,33 +231,25 @@ void EventUI::Render() {
           ImVec2 mousePos = ImGui::GetMousePos();
           bool hoverConsumed = false;
 
-          for (const auto &ev : groupedEvents[cat]) {
+          for (const auto &block : row.Blocks) {
+            const UpcomingEvent &ev = block.Event;
+            float exactMinutes =
+                static_cast<float>(ev.MinutesUntilSpawn) - fractionalMinute;
+
             ImU32 blockColor = GetDistinctColor(cat, colorIndex);
-            ImU32 hoverColor = IM_COL32(255, 255, 255, 100);
             colorIndex++;
 
             float startX =
-                (ev.ExactMinutesUntilSpawn - minOffset) * pixelsPerMinute;
+                (exactMinutes - minOffset) * pixelsPerMinute;
             float blockWidth =
                 static_cast<float>(ev.DurationMinutes) * pixelsPerMinute;
-
-            // Clamp to prevent overlap
-            const auto &evList = groupedEvents[cat];
-            size_t evIdx = &ev - &evList[0];
-            if (evIdx + 1 < evList.size()) {
-              float nextStartX =
-                  (evList[evIdx + 1].ExactMinutesUntilSpawn - minOffset) *
-                  pixelsPerMinute;
-              if (startX + blockWidth > nextStartX) {
-                blockWidth = nextStartX - startX;
-              }
-            }
             if (blockWidth < 1.0f)
               blockWidth = 1.0f; // Always render at least 1px
 
-            ImVec2 blockMin(cellPos.x + startX, cellPos.y + 2.0f);
+            float laneY = cellPos.y + 2.0f + block.Lane * laneHeight;
+            ImVec2 blockMin(cellPos.x + startX, laneY + 1.0f);
             ImVec2 blockMax(cellPos.x + startX + blockWidth,
-                            cellPos.y + rowHeight - 2.0f);
+                            laneY + laneHeight - 1.0f);
 
             // Manual hover check
             bool mouseOverBlock = !hoverConsumed && mousePos.x >= blockMin.x &&
@@ -228,37 +262,40 @@ void EventUI::Render() {
                                   std::to_string(ev.MinutesUntilSpawn);
             // Use InvisibleButton just to register the item in ImGui's system
             ImGui::InvisibleButton(blockId.c_str(),
-                                   ImVec2(blockWidth, rowHeight - 4.0f));
+                                   ImVec2(blockWidth, laneHeight - 2.0f));
 
             // Only the physically-topmost block reacts to click and hover
             bool isClicked = mouseOverBlock && ImGui::IsMouseClicked(0);
+            if (mouseOverBlock && m_Alerts && ImGui::IsMouseClicked(1))
+              m_Alerts->TogglePin(ev.Definition.Name);
             bool isHovered = mouseOverBlock;
 
             if (mouseOverBlock)
               hoverConsumed = true; // mark consumed for rest of row
 
+            TrainTemplate *activeTrain =
+                isClicked ? m_Manager->GetActiveTrain() : nullptr;
             if (isClicked) {
-              if (m_Manager->GetActiveTrain()) {
+              // Steps appended to a body that is not in memory would never
+              // be saved
+              if (activeTrain && activeTrain->StepsLoaded) {
                 TrainStep newStep;
                 newStep.Title = ev.Definition.Name;
 
                 newStep.Description = ev.Definition.Map;
                 newStep.WaypointCode = ev.Definition.WaypointCode;
-                newStep.SquadMessage = ev.Definition.DefaultSquadMessage;
+                // Filled in when sent, so renames and the countdown stay
+                // current; see MessageTemplate
+                newStep.SquadMessage = "Next up: {title} {wp} ({eta})";
                 // Calc UTC spawn minute
                 {
-                  auto nowChrono = std::chrono::system_clock::now();
-                  time_t t_now =
-                      std::chrono::system_clock::to_time_t(nowChrono);
-                  struct tm utcNow = {};
-                  gmtime_s(&utcNow, &t_now);
-                  int currentUTCMinute = utcNow.tm_hour * 60 + utcNow.tm_min;
+                  int currentUTCMinute = clock.MinuteOfDay;
 
                   // Compute UTC spawn minute. Use ceiling for future spawns to
                   // avoid truncating fractional minutes which can make the
                   // overlay consider the event active prematurely. For past
                   // spawns keep floor to preserve negative offsets.
-                  double exact = ev.ExactMinutesUntilSpawn;
+                  double exact = exactMinutes;
                   int deltaMinutes;
                   if (exact > 0.0)
                     deltaMinutes = static_cast<int>(std::ceil(exact));
@@ -271,11 +308,14 @@ void EventUI::Render() {
                 }
                 newStep.DurationMinutes = ev.DurationMinutes;
 
-                auto activeTrain = m_Manager->GetActiveTrain();
                 activeTrain->Steps.push_back(newStep);
+                m_Manager->MarkDirty();
               } else {
-                // No active train - show warning
-                m_ShowNoActiveTrainWarning = true;
+                m_Warning = activeTrain
+                                ? "(!) The active train's steps could not be "
+                                  "read from disk."
+                                : "(!) No active train selected. Go to Editor "
+                                  "and click 'Set Active'.";
                 m_WarningTimer = 3.0f;
               }
             }
@@ -283,6 +323,9 @@ void EventUI::Render() {
             drawList->AddRectFilled(blockMin, blockMax, blockColor, 4.0f);
             drawList->AddRect(blockMin, blockMax, IM_COL32(255, 255, 255, 100), 4.0f,
                               0, 1.5f);
+            if (m_Alerts && m_Alerts->IsPinned(ev.Definition.Name))
+              drawList->AddRect(blockMin, blockMax, IM_COL32(255, 205, 50, 255),
+                                4.0f, 0, 2.5f);
             if (isHovered) {
               ImGui::SetMouseCursor(ImGuiMouseCursor_Hand);
               drawList->AddRectFilled(blockMin, blockMax,
@@ -291,9 +334,9 @@ void EventUI::Render() {
                                 0.0f, 0, 2.0f);
 
               int totalSecs =
-                  static_cast<int>(std::abs(ev.ExactMinutesUntilSpawn * 60.0f));
+                  static_cast<int>(std::abs(exactMinutes * 60.0f));
               std::string hoverTimeStr =
-                  (ev.ExactMinutesUntilSpawn <= 0)
+                  (exactMinutes <= 0)
                       ? "Started " + std::to_string(totalSecs / 60) + "m " +
                             std::to_string(totalSecs % 60) + "s ago"
                       : "in " + std::to_string(totalSecs / 60) + "m " +
@@ -304,19 +347,23 @@ void EventUI::Render() {
                                     "\nMap: " + ev.Definition.Map +
                                     "\nWaypoint: " + ev.Definition.WaypointCode +
                                     "\n" + hoverTimeStr;
+              if (m_Alerts)
+                tooltip += m_Alerts->IsPinned(ev.Definition.Name)
+                               ? "\nRight-click to stop spawn alerts"
+                               : "\nRight-click for spawn alerts";
               ImGui::SetTooltip("%s", tooltip.c_str());
             }
 
             ImVec2 textPos(blockMin.x + 4.0f,
-                           blockMin.y +
-                               (rowHeight - ImGui::GetTextLineHeight()) * 0.5f -
-                               2.0f);
-            drawList->PushClipRect(blockMin, blockMax, true);
-
-            std::string displayName = ev.Definition.Name;
-            drawList->AddText(textPos, IM_COL32(255, 255, 255, 255),
-                              displayName.c_str());
-            drawList->PopClipRect();
+                           blockMin.y + (blockMax.y - blockMin.y -
+                                         ImGui::GetTextLineHeight()) *
+                                            0.5f);
+            LabelCache::Fitted label =
+                m_Labels.Fit(block.NameId, blockWidth - 8.0f);
+            if (label.Begin) {
+              drawList->AddText(textPos, IM_COL32(255, 255, 255, 255),
+                                label.Begin, label.End);
+            }
           }
         }
 
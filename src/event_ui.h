@@ -3,26 +3,55 @@
 
 #include "event_catalog.h"
 #include "imgui/imgui.h"
+#include "label_cache.h"
+#include "spawn_alerts.h"
 #include "train_manager.h"
+#include <string>
+#include <vector>
 
 class EventUI {
 public:
-  EventUI(AddonAPI_t *api, TrainManager *manager, EventCatalog *catalog);
-  void Render();
+  // Without `alerts` events cannot be pinned
+  EventUI(AddonAPI_t *api, TrainManager *manager, EventCatalog *catalog,
+          SpawnAlerts *alerts = nullptr);
+  void Render(const FrameClock &clock);
   bool IsVisible() const { return m_Visible; }
   void Show() { m_Visible = true; }
   void Hide() { m_Visible = false; }
   void Toggle() { m_Visible = !m_Visible; }
 
 private:
+  // One event block placed on a sub-lane of its category row.
+  struct TimelineBlock {
+    UpcomingEvent Event;
+    int Lane = 0;
+    int NameId = -1; // Interned in m_Labels
+  };
+
+  // A category row; overlapping events are stacked on separate lanes so
+  // every block keeps its real duration.
+  struct TimelineRow {
+    std::string Category;
+    std::vector<TimelineBlock> Blocks;
+    int LaneCount = 1;
+  };
+
+  void RebuildTimeline(const FrameClock &clock, int minOffset, int maxOffset);
+
   AddonAPI_t *m_API = nullptr;
-  Texture_t *m_Icon = nullptr;
   bool m_Visible = false;
   bool m_IsFetching = false;
-  bool m_ShowNoActiveTrainWarning = false;
+  const char *m_Warning = nullptr; // Shown for m_WarningTimer seconds
   float m_WarningTimer = 0.0f;
   std::thread m_FetchThread;
   TrainManager *m_Manager = nullptr;
   EventCatalog *m_Catalog = nullptr;
+  SpawnAlerts *m_Alerts = nullptr;
   bool m_IconHovered = false;
+
+  // Lane packing is cached per catalog snapshot and UTC minute
+  std::vector<TimelineRow> m_Timeline;
+  uint64_t m_TimelineRevision = 0;
+  int m_TimelineMinute = -1;
+  LabelCache m_Labels;
 };
@@ -0,0 +1,52 @@
+#include "frame_clock.h"
+#include <chrono>
+#include <utility>
+
+static std::function<int64_t()> s_Source;
+
+static int64_t SystemEpochMilliseconds() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+FrameClock FrameClock::Now() {
+  return FromEpochMilliseconds(s_Source ? s_Source()
+                                        : SystemEpochMilliseconds());
+}
+
+FrameClock FrameClock::FromEpochMilliseconds(int64_t epochMs) {
+  const int64_t msPerDay = 86400000;
+  int64_t msOfDay = ((epochMs % msPerDay) + msPerDay) % msPerDay;
+
+  FrameClock clock;
+  clock.EpochMilliseconds = epochMs;
+  clock.EpochSeconds = (epochMs - msOfDay) / 1000 + msOfDay / 1000;
+  clock.MinuteOfDay = static_cast<int>(msOfDay / 60000);
+  clock.Second = static_cast<int>((msOfDay / 1000) % 60);
+  clock.FractionalMinute = static_cast<float>(msOfDay % 60000) / 60000.0f;
+  return clock;
+}
+
+int FrameClock::SecondsUntilDailySpawn(int spawnMinuteUTC,
+                                       int durationMinutes) const {
+  int diff = spawnMinuteUTC * 60 - SecondOfDay();
+  if (diff > 0)
+    return diff; // Future today
+  if (diff > -(durationMinutes * 60))
+    return diff;       // Currently active (negative)
+  return diff + 86400; // Next occurrence tomorrow
+}
+
+int64_t FrameClock::NextDailyOccurrence(int64_t secondOfDay, int64_t now) {
+  int64_t dayStart =
+      now - ((now % kSecondsPerDay) + kSecondsPerDay) % kSecondsPerDay;
+  int64_t at = dayStart + secondOfDay;
+  int64_t ahead = ((at - now - 1) % kSecondsPerDay + kSecondsPerDay) %
+                  kSecondsPerDay;
+  return now + 1 + ahead;
+}
+
+void FrameClock::SetSource(std::function<int64_t()> epochMsSource) {
+  s_Source = std::move(epochMsSource);
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+// UTC time sampled once per frame and handed to every component, so all
+// windows agree on "now" and nobody calls gmtime on the render thread.
+struct FrameClock {
+  static const int64_t kSecondsPerDay = 86400;
+
+  int64_t EpochMilliseconds = 0;
+  int64_t EpochSeconds = 0;
+  int MinuteOfDay = 0;           // 0-1439
+  int Second = 0;                // 0-59
+  float FractionalMinute = 0.0f; // Elapsed part of the current minute (0-1)
+
+  int SecondOfDay() const { return MinuteOfDay * 60 + Second; }
+  // Seconds until the next daily spawn at `spawnMinuteUTC`; negative while
+  // a spawn lasting `durationMinutes` is still running
+  int SecondsUntilDailySpawn(int spawnMinuteUTC, int durationMinutes) const;
+  // First epoch second after `now` that lies `secondOfDay` into a UTC day.
+  // Offsets outside [0, 1 day) wrap, so the result is in (now, now + 1 day].
+  static int64_t NextDailyOccurrence(int64_t secondOfDay, int64_t now);
+
+  // Samples the active clock source
+  static FrameClock Now();
+  static FrameClock FromEpochMilliseconds(int64_t epochMs);
+
+  // Replaces the system clock, e.g. to simulate a fixed time of day in
+  // benchmarks. Pass an empty function to restore the system clock.
+  static void SetSource(std::function<int64_t()> epochMsSource);
+};
@@ -0,0 +1,126 @@
+#include "label_cache.h"
+#include <cfloat>
+
+// Thresholds for the ellipsized variants, in multiples of the font size
+static const float kVariantWidthsEm[] = {16.0f, 12.0f, 9.0f, 6.0f, 4.0f,
+                                         2.5f};
+
+static const char kEllipsis[] = "...";
+
+// Step back to the start of a UTF-8 sequence so we never cut mid-glyph
+static size_t Utf8Floor(const std::string &text, size_t pos) {
+  while (pos > 0 && pos < text.size() &&
+         (static_cast<unsigned char>(text[pos]) & 0xC0) == 0x80)
+    pos--;
+  return pos;
+}
+
+static float TextWidth(ImFont *font, float size, const char *begin,
+                       const char *end) {
+  return font->CalcTextSizeA(size, FLT_MAX, 0.0f, begin, end).x;
+}
+
+int LabelCache::Intern(const std::string &text) {
+  auto it = m_Ids.find(text);
+  if (it != m_Ids.end())
+    return it->second;
+
+  int id = static_cast<int>(m_Names.size());
+  m_Names.push_back(text);
+  m_Ids.emplace(text, id);
+  return id;
+}
+
+void LabelCache::Clear() {
+  m_Ids.clear();
+  m_Names.clear();
+  m_Fonts.clear();
+}
+
+void LabelCache::Measure(FontMetrics &font, int id) {
+  Metrics &metrics = font.Labels[id];
+  metrics.Measured = true;
+  metrics.Variants.clear();
+
+  const std::string &name = m_Names[id];
+  const char *begin = name.c_str();
+  Variant full;
+  full.Text = name;
+  full.Width = TextWidth(font.Font, font.FontSize, begin, begin + name.size());
+  metrics.Variants.push_back(full);
+
+  float ellipsisWidth =
+      TextWidth(font.Font, font.FontSize, kEllipsis, kEllipsis + 3);
+
+  for (float em : kVariantWidthsEm) {
+    float threshold = em * font.FontSize;
+    if (threshold >= metrics.Variants.back().Width)
+      continue;
+
+    // Longest prefix that still fits next to the ellipsis
+    size_t lo = 0, hi = name.size();
+    while (lo < hi) {
+      size_t mid = Utf8Floor(name, (lo + hi + 1) / 2);
+      if (mid <= lo) {
+        // Only a partial sequence left between lo and hi
+        break;
+      }
+      float w = TextWidth(font.Font, font.FontSize, begin, begin + mid);
+      if (w + ellipsisWidth <= threshold)
+        lo = mid;
+      else
+        hi = mid - 1;
+    }
+    lo = Utf8Floor(name, lo);
+    while (lo > 0 && name[lo - 1] == ' ')
+      lo--;
+    if (lo == 0)
+      break;
+
+    Variant v;
+    v.Text = name.substr(0, lo) + kEllipsis;
+    v.Width = TextWidth(font.Font, font.FontSize, v.Text.c_str(),
+                        v.Text.c_str() + v.Text.size());
+    if (v.Width < metrics.Variants.back().Width)
+      metrics.Variants.push_back(v);
+  }
+}
+
+LabelCache::Fitted LabelCache::Fit(int id, float maxWidth) {
+  Fitted result;
+  if (id < 0 || id >= static_cast<int>(m_Names.size()))
+    return result;
+
+  ImFont *imFont = ImGui::GetFont();
+  float fontSize = ImGui::GetFontSize();
+
+  FontMetrics *font = nullptr;
+  for (auto &f : m_Fonts) {
+    if (f.Font == imFont && f.FontSize == fontSize) {
+      font = &f;
+      break;
+    }
+  }
+  if (!font) {
+    m_Fonts.emplace_back();
+    font = &m_Fonts.back();
+    font->Font = imFont;
+    font->FontSize = fontSize;
+  }
+  if (font->Labels.size() < m_Names.size())
+    font->Labels.resize(m_Names.size());
+
+  Metrics &metrics = font->Labels[id];
+  if (!metrics.Measured)
+    Measure(*font, id);
+
+  for (const auto &v : metrics.Variants) {
+    if (v.Width <= maxWidth) {
+      result.Begin = v.Text.c_str();
+      result.End = v.Text.c_str() + v.Text.size();
+      result.Width = v.Width;
+      break;
+    }
+  }
+  return result;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "imgui/imgui.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Caches text metrics for short labels that are drawn every frame. Labels are
+// interned once and measured once per font; ellipsized variants are
+// precomputed at a few width thresholds so drawing a label that has to fit a
+// given width is a lookup instead of a CalcTextSize call.
+class LabelCache {
+public:
+  struct Fitted {
+    const char *Begin = nullptr;
+    const char *End = nullptr;
+    float Width = 0.0f;
+  };
+
+  // Returns a stable id for the label text
+  int Intern(const std::string &text);
+
+  // Widest variant of the label that fits into maxWidth using the current
+  // ImGui font. Begin is nullptr when not even the shortest variant fits.
+  Fitted Fit(int id, float maxWidth);
+
+  void Clear();
+
+private:
+  struct Variant {
+    std::string Text;
+    float Width = 0.0f;
+  };
+
+  // Full label first, then ellipsized variants sorted by decreasing width
+  struct Metrics {
+    bool Measured = false;
+    std::vector<Variant> Variants;
+  };
+
+  struct FontMetrics {
+    ImFont *Font = nullptr;
+    float FontSize = 0.0f;
+    std::vector<Metrics> Labels;
+  };
+
+  void Measure(FontMetrics &font, int id);
+
+  std::unordered_map<std::string, int> m_Ids;
+  std::vector<std::string> m_Names;
+  std::vector<FontMetrics> m_Fonts;
+};
@@ -0,0 +1,145 @@
+#include "lz_codec.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// A block is a list of sequences:
+//   token        high nibble literal count, low nibble match length - 4
+//                (15 in either means more length bytes follow)
+//   [length...]  255, 255, ..., n added to the literal count
+//   literals
+//   offset       2 bytes little endian, back from the current output end
+//   [length...]  added to the match length
+// The last sequence has literals only and ends the block.
+
+namespace {
+
+const size_t kMinMatch = 4;
+const size_t kMaxOffset = 65535;
+// Matches stop this far before the end so the last sequence always carries
+// literals, as in LZ4
+const size_t kLastLiterals = 5;
+const int kHashBits = 12;
+
+uint32_t Read32(const char *p) {
+  uint32_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+size_t Hash(uint32_t sequence) {
+  return (sequence * 2654435761u) >> (32 - kHashBits);
+}
+
+void PutLength(std::string &out, size_t length) {
+  for (; length >= 255; length -= 255)
+    out.push_back(static_cast<char>(255));
+  out.push_back(static_cast<char>(length));
+}
+
+// `matchLength` 0 writes the final, literals-only sequence
+void PutSequence(std::string &out, const char *literals, size_t literalCount,
+                 size_t offset, size_t matchLength) {
+  size_t extra = matchLength ? matchLength - kMinMatch : 0;
+  out.push_back(static_cast<char>((std::min<size_t>(literalCount, 15) << 4) |
+                                  std::min<size_t>(extra, 15)));
+  if (literalCount >= 15)
+    PutLength(out, literalCount - 15);
+  out.append(literals, literalCount);
+  if (!matchLength)
+    return;
+  out.push_back(static_cast<char>(offset & 0xFF));
+  out.push_back(static_cast<char>(offset >> 8));
+  if (extra >= 15)
+    PutLength(out, extra - 15);
+}
+
+bool GetLength(const char *&p, const char *end, size_t &length) {
+  for (;;) {
+    if (p == end)
+      return false;
+    uint8_t byte = static_cast<uint8_t>(*p++);
+    length += byte;
+    if (byte != 255)
+      return true;
+  }
+}
+
+} // namespace
+
+std::string LzCodec::Compress(std::string_view in) {
+  std::string out;
+  out.reserve(in.size() / 2 + 16);
+  const char *base = in.data();
+  size_t size = in.size();
+  size_t anchor = 0; // Start of the literals not yet written
+
+  if (size > kMinMatch + kLastLiterals) {
+    // Last position seen for each hashed 4-byte sequence
+    std::vector<uint32_t> table(size_t(1) << kHashBits, 0);
+    size_t matchLimit = size - kLastLiterals;
+    size_t pos = 0;
+    while (pos + kMinMatch <= matchLimit) {
+      uint32_t sequence = Read32(base + pos);
+      uint32_t &slot = table[Hash(sequence)];
+      size_t candidate = slot;
+      slot = static_cast<uint32_t>(pos);
+      if (candidate >= pos || pos - candidate > kMaxOffset ||
+          Read32(base + candidate) != sequence) {
+        pos++;
+        continue;
+      }
+
+      size_t length = kMinMatch;
+      while (pos + length < matchLimit &&
+             base[candidate + length] == base[pos + length])
+        length++;
+      PutSequence(out, base + anchor, pos - anchor, pos - candidate, length);
+      pos += length;
+      anchor = pos;
+    }
+  }
+  PutSequence(out, base + anchor, size - anchor, 0, 0);
+  return out;
+}
+
+bool LzCodec::Decompress(std::string_view in, size_t size, std::string &out) {
+  out.clear();
+  out.reserve(size);
+  const char *p = in.data();
+  const char *end = p + in.size();
+
+  while (p < end) {
+    uint8_t token = static_cast<uint8_t>(*p++);
+    size_t literalCount = token >> 4;
+    if (literalCount == 15 && !GetLength(p, end, literalCount))
+      return false;
+    if (literalCount > static_cast<size_t>(end - p) ||
+        literalCount > size - out.size())
+      return false;
+    out.append(p, literalCount);
+    p += literalCount;
+    if (p == end)
+      break; // The final sequence has no match
+
+    if (end - p < 2)
+      return false;
+    size_t offset = static_cast<uint8_t>(p[0]) |
+                    (static_cast<size_t>(static_cast<uint8_t>(p[1])) << 8);
+    p += 2;
+    size_t matchLength = token & 0x0F;
+    if (matchLength == 15 && !GetLength(p, end, matchLength))
+      return false;
+    matchLength += kMinMatch;
+    if (offset == 0 || offset > out.size() || matchLength > size - out.size())
+      return false;
+
+    // Byte by byte: a match may overlap the bytes it produces
+    size_t from = out.size() - offset;
+    for (size_t i = 0; i < matchLength; ++i)
+      out.push_back(out[from + i]);
+  }
+  return out.size() == size;
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// LZ4-style block compression: runs of literals and back references into
+// the last 64 KB, byte aligned, no entropy coding. Much weaker than deflate
+// but dependency-free and fast, and train JSON repeats its keys often
+// enough for it to pay off.
+//
+// The block does not record its own length; callers store the original
+// size next to it and pass it back to Decompress.
+class LzCodec {
+public:
+  static std::string Compress(std::string_view in);
+  // Fails on malformed input or if the output would not be exactly `size`
+  // bytes, so a corrupt or hostile block cannot grow past what was declared
+  static bool Decompress(std::string_view in, size_t size, std::string &out);
+};
@@ -0,0 +1,161 @@
+#include "message_template.h"
+
+#include <cstdio>
+
+namespace {
+
+// Appends the ETA like the overlay shows it
+void AppendEta(int seconds, std::string &out) {
+  if (seconds <= 0) {
+    out += "now";
+    return;
+  }
+  char buf[32];
+  if (seconds >= 3600)
+    snprintf(buf, sizeof(buf), "%dh %02dm", seconds / 3600,
+             (seconds % 3600) / 60);
+  else
+    snprintf(buf, sizeof(buf), "%dm %02ds", seconds / 60, seconds % 60);
+  out += buf;
+}
+
+} // namespace
+
+MessageContext MessageContext::At(const TrainTemplate &train, int stepIndex,
+                                  const FrameClock &clock) {
+  MessageContext context;
+  context.Train = &train;
+  context.StepIndex = stepIndex;
+  if (stepIndex >= 0 && stepIndex < static_cast<int>(train.Steps.size())) {
+    const TrainStep &step = train.Steps[stepIndex];
+    context.HasEta = step.SpawnMinuteUTC >= 0;
+    if (context.HasEta)
+      context.EtaSeconds = clock.SecondsUntilDailySpawn(step.SpawnMinuteUTC,
+                                                        step.DurationMinutes);
+  }
+  return context;
+}
+
+void MessageTemplate::Compile(std::string_view text) {
+  static const struct {
+    std::string_view Name;
+    Field Kind;
+  } kPlaceholders[] = {
+      {"title", Field::Title},          {"wp", Field::Waypoint},
+      {"mechanics", Field::Mechanics},  {"next.title", Field::NextTitle},
+      {"next.wp", Field::NextWaypoint}, {"eta", Field::Eta},
+      {"step", Field::Step},            {"total", Field::Total},
+      {"train", Field::Train},
+  };
+
+  m_Source.assign(text.data(), text.size());
+  m_Literals.clear();
+  m_Tokens.clear();
+  m_HasPlaceholders = false;
+
+  // Extends the literal token at the end, or starts one
+  auto literal = [&](std::string_view part) {
+    if (m_Tokens.empty() || m_Tokens.back().Kind != Field::Literal) {
+      Token token;
+      token.Offset = static_cast<uint32_t>(m_Literals.size());
+      m_Tokens.push_back(token);
+    }
+    m_Literals.append(part.data(), part.size());
+    m_Tokens.back().Length += static_cast<uint32_t>(part.size());
+  };
+
+  size_t pos = 0;
+  while (pos < text.size()) {
+    size_t open = text.find('{', pos);
+    if (open == std::string_view::npos) {
+      literal(text.substr(pos));
+      break;
+    }
+    literal(text.substr(pos, open - pos));
+    if (open + 1 < text.size() && text[open + 1] == '{') {
+      literal("{");
+      pos = open + 2;
+      continue;
+    }
+
+    size_t close = text.find('}', open + 1);
+    if (close == std::string_view::npos) {
+      literal(text.substr(open));
+      break;
+    }
+    std::string_view name = text.substr(open + 1, close - open - 1);
+    const Field *kind = nullptr;
+    for (const auto &placeholder : kPlaceholders) {
+      if (placeholder.Name == name) {
+        kind = &placeholder.Kind;
+        break;
+      }
+    }
+    if (kind) {
+      Token token;
+      token.Kind = *kind;
+      m_Tokens.push_back(token);
+      m_HasPlaceholders = true;
+    } else {
+      literal(text.substr(open, close - open + 1));
+    }
+    pos = close + 1;
+  }
+}
+
+void MessageTemplate::Render(const MessageContext &context,
+                             std::string &out) const {
+  out.clear();
+  const TrainTemplate *train = context.Train;
+  int stepCount = train ? static_cast<int>(train->Steps.size()) : 0;
+  const TrainStep *step =
+      context.StepIndex >= 0 && context.StepIndex < stepCount
+          ? &train->Steps[context.StepIndex]
+          : nullptr;
+  const TrainStep *next =
+      context.StepIndex + 1 >= 0 && context.StepIndex + 1 < stepCount
+          ? &train->Steps[context.StepIndex + 1]
+          : nullptr;
+
+  for (const Token &token : m_Tokens) {
+    switch (token.Kind) {
+    case Field::Literal:
+      out.append(m_Literals, token.Offset, token.Length);
+      break;
+    case Field::Title:
+      if (step)
+        out += step->Title;
+      break;
+    case Field::Waypoint:
+      if (step)
+        out += step->WaypointCode;
+      break;
+    case Field::Mechanics:
+      if (step)
+        out += step->Mechanics;
+      break;
+    case Field::NextTitle:
+      if (next)
+        out += next->Title;
+      break;
+    case Field::NextWaypoint:
+      if (next)
+        out += next->WaypointCode;
+      break;
+    case Field::Eta:
+      if (context.HasEta)
+        AppendEta(context.EtaSeconds, out);
+      break;
+    case Field::Step:
+      out += std::to_string(context.StepIndex + 1);
+      break;
+    case Field::Total:
+      out += std::to_string(stepCount);
+      break;
+    case Field::Train:
+      if (train)
+        out += train->Name;
+      break;
+    }
+  }
+}
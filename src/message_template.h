@@ -0,0 +1,67 @@
+#pragma once
+#include "frame_clock.h"
+#include "train_types.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// What placeholders are filled from: a step of a train and, when the step
+// is scheduled, the seconds until it spawns (negative while it runs).
+struct MessageContext {
+  const TrainTemplate *Train = nullptr;
+  int StepIndex = 0;
+  bool HasEta = false;
+  int EtaSeconds = 0;
+
+  // Step `stepIndex` of `train` as of `clock`
+  static MessageContext At(const TrainTemplate &train, int stepIndex,
+                           const FrameClock &clock);
+};
+
+// Squad message text with placeholders, parsed once into a token list so
+// rendering it every frame only appends strings:
+//   {title} {wp} {mechanics}   of the step
+//   {next.title} {next.wp}     of the step after it (empty at the end)
+//   {eta}                      "4m 05s", "1h 20m", "now"; empty if unscheduled
+//   {step} {total}             1-based position and step count
+//   {train}                    train name
+// "{{" is a literal '{'. Anything else in braces is kept as written, so
+// plain messages render unchanged.
+class MessageTemplate {
+public:
+  MessageTemplate() = default;
+  explicit MessageTemplate(std::string_view text) { Compile(text); }
+
+  void Compile(std::string_view text);
+  // Replaces the contents of `out`, reusing its capacity
+  void Render(const MessageContext &context, std::string &out) const;
+
+  bool HasPlaceholders() const { return m_HasPlaceholders; }
+  const std::string &GetSource() const { return m_Source; }
+
+private:
+  enum class Field : uint8_t {
+    Literal,
+    Title,
+    Waypoint,
+    Mechanics,
+    NextTitle,
+    NextWaypoint,
+    Eta,
+    Step,
+    Total,
+    Train,
+  };
+
+  struct Token {
+    Field Kind = Field::Literal;
+    uint32_t Offset = 0; // Literal text in m_Literals
+    uint32_t Length = 0;
+  };
+
+  std::string m_Source;
+  std::string m_Literals; // Literal runs, escapes resolved
+  std::vector<Token> m_Tokens;
+  bool m_HasPlaceholders = false;
+};
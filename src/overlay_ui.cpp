@@ -1,8 +1,7 @@
 #include "overlay_ui.h"
+#include "addon_icon.h"
+#include "message_template.h"
 #include "imgui/imgui.h"
-#include <windows.h>
-#include <chrono>
-#include <ctime>
 #include <string>
 #include <vector>
 #include <cstring>
@@ -11,91 +10,8 @@
 using json = nlohmann::json;
 #include <fstream>
 
-static bool PostStringToChat(AddonAPI_t *api, const std::string &text, bool asCommander = true) {
-  if (!api)
-    return false;
-
-  if (!api->GameBinds_Press || !api->GameBinds_Release ||
-      !api->WndProc_SendToGameOnly)
-    return false;
-
-  // Focus the appropriate chat input without blocking: prefer async invoke
-  if (asCommander) {
-    if (api->GameBinds_InvokeAsync)
-      api->GameBinds_InvokeAsync(GB_UiSquadBroadcastChatFocus, 50);
-    else {
-      api->GameBinds_Press(GB_UiSquadBroadcastChatFocus);
-      api->GameBinds_Release(GB_UiSquadBroadcastChatFocus);
-    }
-  } else {
-    if (api->GameBinds_InvokeAsync)
-      api->GameBinds_InvokeAsync(GB_UiChatFocus, 50);
-    else {
-      api->GameBinds_Press(GB_UiChatFocus);
-      api->GameBinds_Release(GB_UiChatFocus);
-    }
-  }
-
-  // Build the final string. Prefix with commander chat if requested.
-  std::string out = text;
-  if (asCommander) {
-    // Many servers accept squad chat as commander channel; use /s prefix
-    out = std::string("/s ") + out;
-  }
-
-  // Convert UTF-8 std::string to UTF-16 so we send proper wide characters
-  int req = MultiByteToWideChar(CP_UTF8, 0, out.c_str(), (int)out.size(), NULL, 0);
-  if (req <= 0)
-    return false;
-  std::wstring w;
-  w.resize(req);
-  MultiByteToWideChar(CP_UTF8, 0, out.c_str(), (int)out.size(), &w[0], req);
-
-  // Send each wide char as WM_CHAR without sleeping on the UI thread
-  for (wchar_t wc : w) {
-    if (wc == 0)
-      break;
-    api->WndProc_SendToGameOnly(NULL, WM_CHAR, (WPARAM)wc, 0);
-  }
-
-  // If using squad/commander mode, trigger the squad broadcast command (async when available)
-  if (asCommander) {
-    if (api->GameBinds_InvokeAsync)
-      api->GameBinds_InvokeAsync(GB_UiSquadBroadcastChatCommand, 50);
-    else {
-      api->GameBinds_Press(GB_UiSquadBroadcastChatCommand);
-      api->GameBinds_Release(GB_UiSquadBroadcastChatCommand);
-    }
-    return true;
-  }
-
-  // Fallback: send Enter to submit regular chat
-  api->WndProc_SendToGameOnly(NULL, WM_KEYDOWN, VK_RETURN, 0);
-  api->WndProc_SendToGameOnly(NULL, WM_KEYUP, VK_RETURN, 0);
-  return true;
-}
-
-// Calc seconds until next spawn
-static int SecondsUntilDailySpawn(int spawnMinuteUTC, int durationMinutes) {
-  auto now = std::chrono::system_clock::now();
-  time_t t = std::chrono::system_clock::to_time_t(now);
-  struct tm utc = {};
-  gmtime_s(&utc, &t);
-  int currentSecOfDay = utc.tm_hour * 3600 + utc.tm_min * 60 + utc.tm_sec;
-  int spawnSecOfDay = spawnMinuteUTC * 60;
-  int diff = spawnSecOfDay - currentSecOfDay;
-  if (diff > 0)
-    return diff; // Future today
-  if (diff > -(durationMinutes * 60))
-    return diff;       // Currently active (negative)
-  return diff + 86400; // Next occurrence tomorrow
-}
-
 OverlayUI::OverlayUI(AddonAPI_t *api, TrainManager *manager, EventCatalog *catalog)
-    : m_API(api), m_Manager(manager), m_Catalog(catalog) {
-  if (m_API && m_API->Textures_Get) {
-    m_Icon = m_API->Textures_Get("TC_ICON");
-  }
+    : m_API(api), m_Manager(manager), m_Catalog(catalog), m_Chat(api) {
   // Initialize overlay state
   m_SelectedCustomMessage = -1;
   memset(m_NewMessageBuf, 0, sizeof(m_NewMessageBuf));
@@ -103,13 +19,15 @@ OverlayUI::OverlayUI(AddonAPI_t *api, TrainManager *manager, EventCatalog *catal
   m_PendingPaste = false;
 }
 
-void OverlayUI::Render() {
-  if (!m_Visible || !m_Manager)
-    return;
+void OverlayUI::Render(const FrameClock &clock) {
+  // Callouts and queued broadcasts go out even while the overlay is hidden
+  TrainTemplate *activeTrain = m_Manager ? m_Manager->GetActiveTrain() : nullptr;
+  RunCallouts(activeTrain, clock);
+  m_Chat.Update(ChatQueue::Clock::now());
 
-  TrainTemplate *activeTrain = m_Manager->GetActiveTrain();
-  if (!activeTrain || activeTrain->Steps.empty())
+  if (!m_Visible || !activeTrain || activeTrain->Steps.empty())
     return; // Nothing to show
+  RefreshMessages(*activeTrain);
 
   ImGuiWindowFlags flags = ImGuiWindowFlags_NoCollapse |
                            ImGuiWindowFlags_AlwaysAutoResize |
@@ -121,7 +39,7 @@ void OverlayUI::Render() {
   if (ImGui::Begin("Train Commander - Overlay", &m_Visible, flags)) {
     int currentStepIdx = m_Manager->GetCurrentStepIndex();
 
-    if (m_Icon) {
+    if (Texture_t *icon = AddonIcon::Get(m_API)) {
       float iconSize = m_IconHovered ? 40.0f : 32.0f;
       float offset = m_IconHovered ? -4.0f : 0.0f;
 
@@ -132,7 +50,7 @@ void OverlayUI::Render() {
 
       ImVec4 tint =
           m_IconHovered ? ImVec4(1.2f, 1.2f, 1.2f, 1.0f) : ImVec4(1, 1, 1, 1);
-      ImGui::ImageButton(m_Icon->Resource, ImVec2(iconSize, iconSize),
+      ImGui::ImageButton(icon->Resource, ImVec2(iconSize, iconSize),
                          ImVec2(0, 0), ImVec2(1, 1), 0, ImVec4(0, 0, 0, 0),
                          tint);
       m_IconHovered = ImGui::IsItemHovered();
@@ -146,16 +64,21 @@ void OverlayUI::Render() {
     if (ImGui::Button("Deactivate Train")) {
         m_Manager->SetActiveTrain(-1);
     }
+    if (m_Callouts.GetPendingCount() > 0) {
+      ImGui::SameLine();
+      ImGui::Checkbox("Auto callouts", &m_AutoCallouts);
+    }
     ImGui::Separator();
 
     if (currentStepIdx >= 0 && currentStepIdx < activeTrain->Steps.size()) {
       const auto &currentStep = activeTrain->Steps[currentStepIdx];
+      MessageContext context =
+          MessageContext::At(*activeTrain, currentStepIdx, clock);
       ImGui::Text("Current: %s", currentStep.Title.c_str());
 
       // Countdown if scheduled
-      if (currentStep.SpawnMinuteUTC >= 0) {
-        int secs = SecondsUntilDailySpawn(currentStep.SpawnMinuteUTC,
-                                          currentStep.DurationMinutes);
+      if (context.HasEta) {
+        int secs = context.EtaSeconds;
         int absSecs = secs < 0 ? -secs : secs;
         int h = absSecs / 3600;
         int m = (absSecs % 3600) / 60;
@@ -193,15 +116,27 @@ void OverlayUI::Render() {
         }
 
         if (!currentStep.SquadMessage.empty()) {
-          broadcastStr += currentStep.SquadMessage;
+          // Placeholders are filled in fresh every frame
+          m_StepMessages[currentStepIdx].Squad.Render(context, m_MessageBuf);
+          broadcastStr += m_MessageBuf;
           if (ImGui::Button("Msg")) {
-            ImGui::SetClipboardText(currentStep.SquadMessage.c_str());
+            ImGui::SetClipboardText(m_MessageBuf.c_str());
           }
           ImGui::SameLine();
         }
 
         if (ImGui::Button("Broadcast All (WP + Msg)")) {
-          ImGui::SetClipboardText(broadcastStr.c_str());
+          // Clipboard fallback when Nexus cannot drive the chat
+          if (!m_Chat.Post(broadcastStr))
+            ImGui::SetClipboardText(broadcastStr.c_str());
+        }
+        if (m_Chat.IsBusy()) {
+          auto eta = m_Chat.EstimateDrainTime(ChatQueue::Clock::now());
+          ImGui::TextColored(
+              ImVec4(0.7f, 0.9f, 1.0f, 1.0f),
+              "Sending to chat: %zu queued, done in ~%.0fs",
+              m_Chat.GetPendingCount(),
+              std::chrono::duration<float>(eta).count());
         }
       }
 
@@ -214,6 +149,12 @@ void OverlayUI::Render() {
         if (ImGui::Button("Copy Mechanics")) {
           ImGui::SetClipboardText(currentStep.Mechanics.c_str());
         }
+        ImGui::SameLine();
+        if (ImGui::Button("Broadcast Mechanics")) {
+          // Long blocks go out as several chat lines
+          if (!m_Chat.Post(currentStep.Mechanics))
+            ImGui::SetClipboardText(currentStep.Mechanics.c_str());
+        }
       }
 
       // Custom messages for current step
@@ -256,7 +197,7 @@ void OverlayUI::Render() {
 
     if (ImGui::Button("Next >") &&
         currentStepIdx < activeTrain->Steps.size() - 1) {
-      m_manager->NextStep();
+      m_Manager->NextStep();
     }
 
     ImGui::Spacing();
@@ -272,29 +213,10 @@ void OverlayUI::Render() {
 
     if (currentStepIdx + 1 < (int)activeTrain->Steps.size()) {
       ImGui::Separator();
-      const auto &nextStep = activeTrain->Steps[currentStepIdx + 1];
       if (ImGui::Button("Copy Next Boss")) {
-        // Build a message that contains only the "Next up:" part.
         std::string msg;
-        if (!nextStep.SquadMessage.empty()) {
-          // If SquadMessage already contains "Next up:", use that substring.
-          std::string tmp = nextStep.SquadMessage;
-          std::string lower = tmp;
-          for (char &c : lower)
-            c = (char)tolower((unsigned char)c);
-          size_t pos = lower.find("next up:");
-          if (pos != std::string::npos) {
-            msg = tmp.substr(pos);
-            while (!msg.empty() && (msg[0] == ' ' || msg[0] == '-' || msg[0] == '\t'))
-              msg.erase(msg.begin());
-          }
-        }
-        if (msg.empty()) {
-          // Fallback: construct a clean "Next up: <Title> <WP>" message
-          msg = std::string("Next up: ") + nextStep.Title;
-          if (!nextStep.WaypointCode.empty())
-            msg += " " + nextStep.WaypointCode;
-        }
+        m_StepMessages[currentStepIdx + 1].Announcement.Render(
+            MessageContext::At(*activeTrain, currentStepIdx + 1, clock), msg);
 
         // Fallback: copy to clipboard and ask the user to paste manually
         ImGui::SetClipboardText(msg.c_str());
@@ -312,3 +234,73 @@ void OverlayUI::Render() {
   // No automatic paste sequence active — clipboard fallback only
   (void)m_PendingPaste;
 }
+
+void OverlayUI::RefreshMessages(const TrainTemplate &train) {
+  uint64_t revision = m_Manager->GetRevision();
+  if (&train == m_MessagesTrain && revision == m_MessagesRevision &&
+      m_StepMessages.size() == train.Steps.size())
+    return;
+  m_MessagesTrain = &train;
+  m_MessagesRevision = revision;
+
+  // Steps without their own "Next up:" line are announced generically
+  static const std::string kNextUp = "next up:";
+  m_StepMessages.resize(train.Steps.size());
+  for (size_t i = 0; i < train.Steps.size(); ++i) {
+    const TrainStep &step = train.Steps[i];
+    m_StepMessages[i].Squad.Compile(step.SquadMessage);
+
+    std::string lower = step.SquadMessage;
+    for (char &c : lower)
+      c = (char)tolower((unsigned char)c);
+    size_t pos = lower.find(kNextUp);
+    if (pos != std::string::npos) {
+      m_StepMessages[i].Announcement.Compile(
+          std::string_view(step.SquadMessage).substr(pos));
+    } else {
+      m_StepMessages[i].Announcement.Compile(
+          step.WaypointCode.empty() ? "Next up: {title}"
+                                    : "Next up: {title} {wp}");
+    }
+  }
+}
+
+void OverlayUI::RunCallouts(const TrainTemplate *train,
+                            const FrameClock &clock) {
+  m_Callouts.Sync(train, m_Manager ? m_Manager->GetRevision() : 0, clock);
+  m_DueCallouts.clear();
+  m_Callouts.Update(clock, m_DueCallouts);
+  if (m_DueCallouts.empty() || !m_AutoCallouts)
+    return;
+
+  RefreshMessages(*train);
+  std::string text;
+  for (const CalloutScheduler::Due &due : m_DueCallouts) {
+    const TrainStep &step = train->Steps[due.StepIndex];
+    const Callout &callout = step.Callouts[due.CalloutIndex];
+    MessageContext context = MessageContext::At(*train, due.StepIndex, clock);
+    text.clear();
+    switch (callout.Content) {
+    case CalloutContent::WaypointAndMessage:
+      m_StepMessages[due.StepIndex].Squad.Render(context, m_MessageBuf);
+      text = step.WaypointCode;
+      if (!text.empty() && !m_MessageBuf.empty())
+        text += " ";
+      text += m_MessageBuf;
+      break;
+    case CalloutContent::Message:
+      m_StepMessages[due.StepIndex].Squad.Render(context, text);
+      break;
+    case CalloutContent::Mechanics:
+      text = step.Mechanics;
+      break;
+    case CalloutContent::CustomMessage:
+      if (callout.CustomMessageIndex >= 0 &&
+          callout.CustomMessageIndex < (int)step.CustomMessages.size())
+        text = step.CustomMessages[callout.CustomMessageIndex].text;
+      break;
+    }
+    if (!text.empty())
+      m_Chat.Post(text);
+  }
+}
@@ -1,7 +1,10 @@
 #pragma once
 #include "nexus/Nexus.h"
 
+#include "callout_scheduler.h"
+#include "chat_queue.h"
 #include "event_catalog.h" 
+#include "message_template.h"
 #include "train_manager.h"
 #include <vector>
 #include <cstring>
@@ -11,24 +14,41 @@ public:
   OverlayUI(AddonAPI_t *api, TrainManager *manager, EventCatalog *catalog);
   ~OverlayUI() = default;
 
-  void Render();
+  void Render(const FrameClock &clock);
 
   bool IsVisible() const { return m_Visible; }
   void Show() { m_Visible = true; }
   void Hide() { m_Visible = false; }
   void Toggle() { m_Visible = !m_Visible; }
 
+  ChatQueue &GetChatQueue() { return m_Chat; }
+
 private:
+  // Compiled squad messages of a step. Announcement is what "Copy Next
+  // Boss" copies: the message from its "Next up:" on, or a generic one.
+  struct StepMessages {
+    MessageTemplate Squad;
+    MessageTemplate Announcement;
+  };
+
+  // Recompiles the step messages when the train or the library changed
+  void RefreshMessages(const TrainTemplate &train);
+  // Sends the timed callouts that came due this frame
+  void RunCallouts(const TrainTemplate *train, const FrameClock &clock);
+
   AddonAPI_t *m_API;
-  Texture_t *m_Icon = nullptr;
   TrainManager *m_Manager;
   EventCatalog *m_Catalog;
   bool m_Visible = true;
   bool m_IconHovered = false;
-  // Deferred chat send state
-  std::wstring m_PendingWideMsg;
-  size_t m_PendingIndex = 0;
-  int m_PendingDelayFrames = 0;
+  ChatQueue m_Chat;
+  std::vector<StepMessages> m_StepMessages;
+  const TrainTemplate *m_MessagesTrain = nullptr;
+  uint64_t m_MessagesRevision = 0;
+  std::string m_MessageBuf; // Reused render target
+  CalloutScheduler m_Callouts;
+  std::vector<CalloutScheduler::Due> m_DueCallouts;
+  bool m_AutoCallouts = true;
   bool m_PendingPaste = false;
   std::string m_PendingClipboardMsg;
   int m_PendingPasteState = 0; // 0=init,1=after-clear,2=pasted
@@ -0,0 +1,37 @@
+#include "platform.h"
+#include <filesystem>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+std::string Platform::JoinPath(const std::string &dir,
+                               const std::string &name) {
+  return (fs::path(dir) / name).string();
+}
+
+bool Platform::EnsureDirectory(const std::string &path) {
+  std::error_code ec;
+  fs::create_directories(path, ec);
+  return fs::is_directory(path, ec);
+}
+
+bool Platform::FileExists(const std::string &path) {
+  std::error_code ec;
+  return fs::exists(path, ec);
+}
+
+bool Platform::RemoveFile(const std::string &path) {
+  std::error_code ec;
+  return fs::remove(path, ec);
+}
+
+std::vector<std::string> Platform::ListDirectory(const std::string &path) {
+  std::vector<std::string> names;
+  std::error_code ec;
+  for (fs::directory_iterator it(path, ec), end; !ec && it != end;
+       it.increment(ec)) {
+    if (it->is_regular_file(ec))
+      names.push_back(it->path().filename().string());
+  }
+  return names;
+}
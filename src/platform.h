@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Thin OS layer for the core library. Filesystem helpers are portable;
+// HttpGet is implemented per platform (WinINet on Windows).
+namespace Platform {
+
+// Joins a directory and a file name with the native separator
+std::string JoinPath(const std::string &dir, const std::string &name);
+
+// Creates the directory (and parents) if missing
+bool EnsureDirectory(const std::string &path);
+bool FileExists(const std::string &path);
+bool RemoveFile(const std::string &path);
+// Names (not paths) of the regular files directly inside `path`
+std::vector<std::string> ListDirectory(const std::string &path);
+
+// Read-only view of a whole file, mapped into memory instead of copied
+// (CreateFileMapping on Windows, mmap elsewhere). Files the core writes are
+// replaced by rename or only appended to, so a view never sees them shrink.
+class MappedFile {
+public:
+  MappedFile() = default;
+  ~MappedFile() { Close(); }
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  // False if the file is missing or cannot be mapped. An empty file opens
+  // as an empty view.
+  bool Open(const std::string &path);
+  void Close();
+
+  std::string_view View() const { return {m_Data, m_Size}; }
+
+private:
+  const char *m_Data = nullptr;
+  size_t m_Size = 0;
+};
+
+// Writes to `path`.tmp, flushes it to disk and renames it over `path`, so
+// a crash leaves either the old or the new file, never a torn one.
+bool WriteFileAtomic(const std::string &path, const std::string &data);
+// Appends and flushes to disk before returning
+bool AppendFile(const std::string &path, const std::string &data);
+
+// Blocking GET of `url` into `body`. Returns false if the request failed.
+bool HttpGet(const std::string &url, const std::string &userAgent,
+             std::string &body);
+
+} // namespace Platform
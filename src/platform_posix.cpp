@@ -0,0 +1,79 @@
+#ifndef _WIN32
+#include "platform.h"
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// No network stack in the Linux core build; the catalog stays empty until
+// events are supplied through EventCatalog::SetEvents.
+bool Platform::HttpGet(const std::string &, const std::string &,
+                       std::string &) {
+  return false;
+}
+
+static bool WriteAll(int fd, const std::string &data) {
+  size_t offset = 0;
+  while (offset < data.size()) {
+    ssize_t n = write(fd, data.data() + offset, data.size() - offset);
+    if (n < 0)
+      return false;
+    offset += static_cast<size_t>(n);
+  }
+  return true;
+}
+
+bool Platform::WriteFileAtomic(const std::string &path,
+                               const std::string &data) {
+  std::string tmpPath = path + ".tmp";
+  int fd = open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+    return false;
+
+  bool ok = WriteAll(fd, data) && fsync(fd) == 0;
+  ok = close(fd) == 0 && ok;
+  if (!ok) {
+    unlink(tmpPath.c_str());
+    return false;
+  }
+  return std::rename(tmpPath.c_str(), path.c_str()) == 0;
+}
+
+bool Platform::AppendFile(const std::string &path, const std::string &data) {
+  int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+  if (fd < 0)
+    return false;
+
+  bool ok = WriteAll(fd, data) && fsync(fd) == 0;
+  return close(fd) == 0 && ok;
+}
+
+bool Platform::MappedFile::Open(const std::string &path) {
+  Close();
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+
+  struct stat st;
+  bool ok = fstat(fd, &st) == 0;
+  if (ok && st.st_size > 0) {
+    void *data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ,
+                      MAP_PRIVATE, fd, 0);
+    ok = data != MAP_FAILED;
+    if (ok) {
+      m_Data = static_cast<const char *>(data);
+      m_Size = static_cast<size_t>(st.st_size);
+    }
+  }
+  close(fd); // The mapping keeps the file alive
+  return ok;
+}
+
+void Platform::MappedFile::Close() {
+  if (m_Data)
+    munmap(const_cast<char *>(m_Data), m_Size);
+  m_Data = nullptr;
+  m_Size = 0;
+}
+#endif
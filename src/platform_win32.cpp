@@ -0,0 +1,108 @@
+#ifdef _WIN32
+#include "platform.h"
+#include <windows.h>
+#include <wininet.h>
+
+#pragma comment(lib, "wininet.lib")
+
+bool Platform::HttpGet(const std::string &url, const std::string &userAgent,
+                       std::string &body) {
+  HINTERNET hInternet = InternetOpenA(
+      userAgent.c_str(), INTERNET_OPEN_TYPE_PRECONFIG, NULL, NULL, 0);
+  if (!hInternet)
+    return false;
+
+  HINTERNET hConnect =
+      InternetOpenUrlA(hInternet, url.c_str(), NULL, 0,
+                       INTERNET_FLAG_RELOAD | INTERNET_FLAG_SECURE, 0);
+  if (!hConnect) {
+    InternetCloseHandle(hInternet);
+    return false;
+  }
+
+  char buffer[4096];
+  DWORD bytesRead = 0;
+  while (InternetReadFile(hConnect, buffer, sizeof(buffer), &bytesRead) &&
+         bytesRead > 0) {
+    body.append(buffer, bytesRead);
+  }
+
+  InternetCloseHandle(hConnect);
+  InternetCloseHandle(hInternet);
+  return true;
+}
+
+bool Platform::WriteFileAtomic(const std::string &path,
+                               const std::string &data) {
+  std::string tmpPath = path + ".tmp";
+  HANDLE hFile = CreateFileA(tmpPath.c_str(), GENERIC_WRITE, 0, NULL,
+                             CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (hFile == INVALID_HANDLE_VALUE)
+    return false;
+
+  DWORD written = 0;
+  bool ok = WriteFile(hFile, data.data(), (DWORD)data.size(), &written,
+                      NULL) &&
+            written == data.size();
+  ok = ok && FlushFileBuffers(hFile);
+  CloseHandle(hFile);
+
+  if (!ok) {
+    DeleteFileA(tmpPath.c_str());
+    return false;
+  }
+  return MoveFileExA(tmpPath.c_str(), path.c_str(),
+                     MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+}
+
+bool Platform::AppendFile(const std::string &path, const std::string &data) {
+  HANDLE hFile = CreateFileA(path.c_str(), FILE_APPEND_DATA, FILE_SHARE_READ,
+                             NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (hFile == INVALID_HANDLE_VALUE)
+    return false;
+
+  DWORD written = 0;
+  bool ok = WriteFile(hFile, data.data(), (DWORD)data.size(), &written,
+                      NULL) &&
+            written == data.size();
+  ok = ok && FlushFileBuffers(hFile);
+  CloseHandle(hFile);
+  return ok;
+}
+
+bool Platform::MappedFile::Open(const std::string &path) {
+  Close();
+  // Shared so the writer thread can still replace or remove files while a
+  // view is open; a removal that fails is retried by the next compaction
+  HANDLE hFile = CreateFileA(path.c_str(), GENERIC_READ,
+                             FILE_SHARE_READ | FILE_SHARE_DELETE, NULL,
+                             OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (hFile == INVALID_HANDLE_VALUE)
+    return false;
+
+  LARGE_INTEGER size;
+  bool ok = GetFileSizeEx(hFile, &size) != 0;
+  if (ok && size.QuadPart > 0) {
+    // Mapping a zero-length file fails, so only non-empty ones get a view
+    HANDLE hMapping = CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+    void *data =
+        hMapping ? MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+    ok = data != NULL;
+    if (ok) {
+      m_Data = static_cast<const char *>(data);
+      m_Size = static_cast<size_t>(size.QuadPart);
+    }
+    if (hMapping)
+      CloseHandle(hMapping); // The view keeps the mapping alive
+  }
+  CloseHandle(hFile);
+  return ok;
+}
+
+void Platform::MappedFile::Close() {
+  if (m_Data)
+    UnmapViewOfFile(m_Data);
+  m_Data = nullptr;
+  m_Size = 0;
+}
+#endif
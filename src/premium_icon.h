@@ -1,2 +1,8 @@
 #pragma once
-const char* PREMIUM_ICON_B64 = "iVBORw0KGgoAAAANSUhEUgAAAEAAAABACAYAAACqaXHeAAAAAXNSR0IB2cksfwAAAAlwSFlzAAALEwAACxMBAJqcGAAACbxJREFUeJztWwlQlEcWHg65j6AooNEkYEwUQyArusaoQcALFOXwAI2yCgpC1DJI1IjhUmQJArIgICCI4EEkSoySIBiBJCJgNJpsbaVqj2Q3pna3ard2t7JX9m2/N3/P/Awzw8w/E0Z2p6u++pn+u//u93X369evHzKZOZmTOZmTOT3SqZihXwUDKmhlSDdVB3/IFO/s7AgTxrtpxVg3F2BlEf9TJMQzQPK2aHi7KW8wzubBRRHKS9LB2ckBCWg1daeNmaoZIOfNJPji03NaceP9cnB3fwwJ+NrUnTZmOskA2Ye2DUtAZ1sZjBvnigR8ZepOGzPlMsCulPXDEoDLwtZmDBLQb4yGixj6jIgiif1YxkBKbjgCkhKjuBIsltiWIhVZWloMq3X1wZgx1mAACeUo2KEDCRqFv9JSCC4ujtjGF4YKj6lvqs9kaG48YjRs3hjOR+eImvb2MVwR3iPuMZSJ3sdh/lNPToKeziq1BOzYHsPrVhmDAIiODB52yumDhtos3sEuNcLD2LEusDY6BNbFhMKkiRN4WTEJTZhXkLdzyLc7rv6M1Sfl92sGK6MQELFioVEJKD32GheqRdSOE8MVBwc7qCjdpyh76cJPYdIkBQlHhbKV+DsrI1Gt8pNZWBhN+WHqsrKygk0bwuDjG9UGC19SmAaODvZcoD2idhowL4VNX9U6jXXZvHyPULYCf2ceHKoHiAB5WaMR4CuTT1WwtbWBLZsjDCIAjRihg9Uq7fzKgo1c+9XSIXUeDJxlRo0b1vleFwIsjDwDMHkxXGL4o+8M70EN3rpZAzfbT2hEd0clCaAkYLsmAsBjwliNxIUEzeb1MGldAj8EAYpOzhQRMPBxPQTOmqF1y/P0GAe1FQd1IgA1uyYCYpgifjQI8PVRNNZ9vRI8mIAs/yHD7zSAdXSbiACNSwAmMo2viYCo1YseQQLY9Pb0dMfGvtVQvkqVgNxMBQE1Qid7hWe/l+d4jQSsiQoRK7c+bQTILBTleFm0N8JMRkC2iIDDWclckCHQRkDUqqAh5dUpwWblLqAOBpOgbQloJEA8A/p6Tg06x58/c1jxd8u5fI0EtLWWUBkUUG5R5rFt+eSQcqiXLrD3/JtYdver6/myUGd5jgQBQ6fqSKLzWjk7GpNv4DcGEyDeBkcLAYiNscv4Mog3iADxNijSAVqRm5VkcgK07D7SCUDs37uZHVxC6fCCWEOHmMWK33jy03RqG0mcLD/ACWgzKgGjBa0X3yJTnsnw4P+SADTL0TKVyY0zvZM7QzPDQ9WzwGjBvdtnYNrTU5CAf0ghoBkvGvyeexpWrXzZ5MJIwed3zsKM6U8hAf+RQsDD8GUv0banzvgYLcDZK1OeJ/RKsHqUjjxHb3ctTJnsicL/SRIB4cvnm1wIQ9B5rYz7CiVZgxAZEWRyIQwB+hYFd/w9SQTgaczUQhgCQw0ho7vGRxqHDmzlBJRLIiBmFBNwv78RFi74EScgThIB6JExtSBS0f5eKTzm6ozC/1KK8ERAdOQikwuiL+58Ug9Hc1NgSeiP+eiflkzAaFwCIvsfgbEFm6UIn4EfCGOWoKkF0hcUJSL3BImBJNjpQ8D7T0zxguoTb5hcIH2B/sH8w6nklMWoktmzfDkJp/QhgJwcphbGGGhrPQ6WlpZIwJcMNroToGUH+KyvEXLfTIIX5/pBIGP4td0boadT+4EJ1+ZPNq0Ev5lTIWjhLCgrTqfT2kiQEK28YarRmYBILVYgXnTY2dkOWmdRq4OJGHXl8Vw+J3Cm+M6f6leVHRgRAq5dLuaeoV8wuOpCQIfHhHFwquoQ1Fdnwjvn88nf/vkd9ApXwUSv8VyYrzkBaHMX5O2iUcVwFSyPDWMHMvZvVVVKBDyp9fXUwa2uWoU/nwPt+N7uelb/PHRcq6A7gcFl8lhfTrL2mqGrvQbevVhI+efPHKG7hvsDTYNIWBE2n7fbpAsBWbyT1tZWBFdmVCABb7y+RSHAyvAFkBC/ikYT19nikLlEwPIl8wDjC2Ii5cvoBf/p9N7W1pbIeMH/WcU3jh9Lg462Mn6JQbBkf2cfSoK+j+qp/kc3qplOCh1UBmfohx9UUp/6Wbnigj3g5GhP7aAX6G5vwyACMITORh5BhiF0j+tKQgfDDYa706ZOoQ+h9xc7gFsNbjlSpuSlCwUKQTL2b6E8sXDoiPn0VgMsY0Q6ONjDvrR4Eki46ACcnV3tFZB5MJGsPfRQ3+45BXt2xtJ7TS48PN4LbbyrCwHiBJyA2LVL6CMYu4tXV5iHo/5ZXxPcvd0oKLxKNiWL2Aiept88VqC3q46eeI3FhUUXuyoBl5sL4NUda2k0vb296R0ux31pm+g9Phtqs9nMtAYPDw+aWXiT3MKWKsYJaiIAHSSCLkAHiZs+BHzv6uJEgmA8Lu9s8MuBsGH9cloCiBWCA2Vl2AJaNnHrltLvl14MoPJYBgV73m+aQtjayoPkchN+/wG/jXVmB/pCQmIC/OWvf4aAgAC6a8C2sRxeeKTt3gD+/v7w8NtvID19LwmNswIDLrQ5cfkMZjinDwH3sVLr22/RdualvBn6UnjWI/OF+bupE8L7b9AIQdIOZ+0AjDvkQnP4eD9O6zc/N5XnNXACgoMCISs7C/75r79DWFgYbE+IhLP1OUQ+EpAQHwGhoaHw3Xd/g5KSYp0J+PCDCnB0pHil3+pDwAnsIIas4FZ34vjrTCk6KQTB0d6+NZI0L65pIb8MpxuOGuZHrVo0SHhnJ0doqsumTgU8/wzP/zk+r7Qcg+TEaJreCQkJTHnZUJt444zvd6Wsg9Nsd3J1dYG4uFjw8fGGpYvnsiVZTNHiw7nxQ4PnSHKUXsZRRgMGBcKwtpBFc2DuHD84mrODjWQdXL9aCk8+4cU/HotPDIFBBXWrq4YpqTgIYDsATkPcrrAzhfm7+JLCKUmB0fger9bQJT/e3Y2U4Z1PTsNzzIjC9xjEeZON9itxYWBvb0cE4rZ4RIhDcHNzgdKiNI1Bm9OfJVd5n74E7MWPo9atrcwYwipuM74zfBRTWaiD/7gA8+cF0FamWgfJFMxURCqDNUM35p2py6Ey9wUFistLply7kJq8lpweDwbk33rvnSLuANUVksJ2iQQcsfnz/NkIhDPzNoKMDAx2lCkNDSeh/GSZEALrxKZmNNPUmzaEk3LE0RV1Zq+ojTyZYFitjgiC5G1r2Kl0nrhsKv8b+7AzZT3rwwpa+zLlEThNJo9wM3bgNqVMhuuyoYx+JQivamp6yOTRob9XU+eyivBiErqFMv+WKUc+VXi/WCYy1mRK/YHCWxsi3GhLSxlyhKc5mZM5mZM5SU3/BXeBZTQNPIolAAAAAElFTkSuQmCC";
+#include "base64.h"
+
+// QuickAccess / window icon (64x64 PNG), decoded at compile time
+constexpr char PREMIUM_ICON_B64[] = "iVBORw0KGgoAAAANSUhEUgAAAEAAAABACAYAAACqaXHeAAAAAXNSR0IB2cksfwAAAAlwSFlzAAALEwAACxMBAJqcGAAACbxJREFUeJztWwlQlEcWHg65j6AooNEkYEwUQyArusaoQcALFOXwAI2yCgpC1DJI1IjhUmQJArIgICCI4EEkSoySIBiBJCJgNJpsbaVqj2Q3pna3ard2t7JX9m2/N3/P/Awzw8w/E0Z2p6u++pn+u//u93X369evHzKZOZmTOZmTOT3SqZihXwUDKmhlSDdVB3/IFO/s7AgTxrtpxVg3F2BlEf9TJMQzQPK2aHi7KW8wzubBRRHKS9LB2ckBCWg1daeNmaoZIOfNJPji03NaceP9cnB3fwwJ+NrUnTZmOskA2Ye2DUtAZ1sZjBvnigR8ZepOGzPlMsCulPXDEoDLwtZmDBLQb4yGixj6jIgiif1YxkBKbjgCkhKjuBIsltiWIhVZWloMq3X1wZgx1mAACeUo2KEDCRqFv9JSCC4ujtjGF4YKj6lvqs9kaG48YjRs3hjOR+eImvb2MVwR3iPuMZSJ3sdh/lNPToKeziq1BOzYHsPrVhmDAIiODB52yumDhtos3sEuNcLD2LEusDY6BNbFhMKkiRN4WTEJTZhXkLdzyLc7rv6M1Sfl92sGK6MQELFioVEJKD32GheqRdSOE8MVBwc7qCjdpyh76cJPYdIkBQlHhbKV+DsrI1Gt8pNZWBhN+WHqsrKygk0bwuDjG9UGC19SmAaODvZcoD2idhowL4VNX9U6jXXZvHyPULYCf2ceHKoHiAB5WaMR4CuTT1WwtbWBLZsjDCIAjRihg9Uq7fzKgo1c+9XSIXUeDJxlRo0b1vleFwIsjDwDMHkxXGL4o+8M70EN3rpZAzfbT2hEd0clCaAkYLsmAsBjwliNxIUEzeb1MGldAj8EAYpOzhQRMPBxPQTOmqF1y/P0GAe1FQd1IgA1uyYCYpgifjQI8PVRNNZ9vRI8mIAs/yHD7zSAdXSbiACNSwAmMo2viYCo1YseQQLY9Pb0dMfGvtVQvkqVgNxMBQE1Qid7hWe/l+d4jQSsiQoRK7c+bQTILBTleFm0N8JMRkC2iIDDWclckCHQRkDUqqAh5dUpwWblLqAOBpOgbQloJEA8A/p6Tg06x58/c1jxd8u5fI0EtLWWUBkUUG5R5rFt+eSQcqiXLrD3/JtYdver6/myUGd5jgQBQ6fqSKLzWjk7GpNv4DcGEyDeBkcLAYiNscv4Mog3iADxNijSAVqRm5VkcgK07D7SCUDs37uZHVxC6fCCWEOHmMWK33jy03RqG0mcLD/ACWgzKgGjBa0X3yJTnsnw4P+SADTL0TKVyY0zvZM7QzPDQ9WzwGjBvdtnYNrTU5CAf0ghoBkvGvyeexpWrXzZ5MJIwed3zsKM6U8hAf+RQsDD8GUv0banzvgYLcDZK1OeJ/RKsHqUjjxHb3ctTJnsicL/SRIB4cvnm1wIQ9B5rYz7CiVZgxAZEWRyIQwB+hYFd/w9SQTgaczUQhgCQw0ho7vGRxqHDmzlBJRLIiBmFBNwv78RFi74EScgThIB6JExtSBS0f5eKTzm6ozC/1KK8ERAdOQikwuiL+58Ug9Hc1NgSeiP+eiflkzAaFwCIvsfgbEFm6UIn4EfCGOWoKkF0hcUJSL3BImBJNjpQ8D7T0zxguoTb5hcIH2B/sH8w6nklMWoktmzfDkJp/QhgJwcphbGGGhrPQ6WlpZIwJcMNroToGUH+KyvEXLfTIIX5/pBIGP4td0boadT+4EJ1+ZPNq0Ev5lTIWjhLCgrTqfT2kiQEK28YarRmYBILVYgXnTY2dkOWmdRq4OJGHXl8Vw+J3Cm+M6f6leVHRgRAq5dLuaeoV8wuOpCQIfHhHFwquoQ1Fdnwjvn88nf/vkd9ApXwUSv8VyYrzkBaHMX5O2iUcVwFSyPDWMHMvZvVVVKBDyp9fXUwa2uWoU/nwPt+N7uelb/PHRcq6A7gcFl8lhfTrL2mqGrvQbevVhI+efPHKG7hvsDTYNIWBE2n7fbpAsBWbyT1tZWBFdmVCABb7y+RSHAyvAFkBC/ikYT19nikLlEwPIl8wDjC2Ii5cvoBf/p9N7W1pbIeMH/WcU3jh9Lg462Mn6JQbBkf2cfSoK+j+qp/kc3qplOCh1UBmfohx9UUp/6Wbnigj3g5GhP7aAX6G5vwyACMITORh5BhiF0j+tKQgfDDYa706ZOoQ+h9xc7gFsNbjlSpuSlCwUKQTL2b6E8sXDoiPn0VgMsY0Q6ONjDvrR4Eki46ACcnV3tFZB5MJGsPfRQ3+45BXt2xtJ7TS48PN4LbbyrCwHiBJyA2LVL6CMYu4tXV5iHo/5ZXxPcvd0oKLxKNiWL2Aiept88VqC3q46eeI3FhUUXuyoBl5sL4NUda2k0vb296R0ux31pm+g9Phtqs9nMtAYPDw+aWXiT3MKWKsYJaiIAHSSCLkAHiZs+BHzv6uJEgmA8Lu9s8MuBsGH9cloCiBWCA2Vl2AJaNnHrltLvl14MoPJYBgV73m+aQtjayoPkchN+/wG/jXVmB/pCQmIC/OWvf4aAgAC6a8C2sRxeeKTt3gD+/v7w8NtvID19LwmNswIDLrQ5cfkMZjinDwH3sVLr22/RdualvBn6UnjWI/OF+bupE8L7b9AIQdIOZ+0AjDvkQnP4eD9O6zc/N5XnNXACgoMCISs7C/75r79DWFgYbE+IhLP1OUQ+EpAQHwGhoaHw3Xd/g5KSYp0J+PCDCnB0pHil3+pDwAnsIIas4FZ34vjrTCk6KQTB0d6+NZI0L65pIb8MpxuOGuZHrVo0SHhnJ0doqsumTgU8/wzP/zk+r7Qcg+TEaJreCQkJTHnZUJt444zvd6Wsg9Nsd3J1dYG4uFjw8fGGpYvnsiVZTNHiw7nxQ4PnSHKUXsZRRgMGBcKwtpBFc2DuHD84mrODjWQdXL9aCk8+4cU/HotPDIFBBXWrq4YpqTgIYDsATkPcrrAzhfm7+JLCKUmB0fger9bQJT/e3Y2U4Z1PTsNzzIjC9xjEeZON9itxYWBvb0cE4rZ4RIhDcHNzgdKiNI1Bm9OfJVd5n74E7MWPo9atrcwYwipuM74zfBRTWaiD/7gA8+cF0FamWgfJFMxURCqDNUM35p2py6Ey9wUFistLply7kJq8lpweDwbk33rvnSLuANUVksJ2iQQcsfnz/NkIhDPzNoKMDAx2lCkNDSeh/GSZEALrxKZmNNPUmzaEk3LE0RV1Zq+ojTyZYFitjgiC5G1r2Kl0nrhsKv8b+7AzZT3rwwpa+zLlEThNJo9wM3bgNqVMhuuyoYx+JQivamp6yOTRob9XU+eyivBiErqFMv+WKUc+VXi/WCYy1mRK/YHCWxsi3GhLSxlyhKc5mZM5mZM5SU3/BXeBZTQNPIolAAAAAElFTkSuQmCC";
+constexpr size_t PREMIUM_ICON_SIZE = Base64::LiteralSize(PREMIUM_ICON_B64);
+constexpr auto PREMIUM_ICON_PNG =
+    Base64::DecodeLiteral<PREMIUM_ICON_SIZE>(PREMIUM_ICON_B64);
@@ -0,0 +1,103 @@
+#include "profiler.h"
+
+#if TC_ENABLE_PROFILER
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+const size_t kWindowSize = 1024; // Samples kept per section
+
+struct Section {
+  explicit Section(const char *name) : Name(name) {}
+
+  const char *Name = nullptr;
+  std::vector<float> Samples; // Ring buffer, milliseconds
+  size_t Next = 0;
+  uint64_t Total = 0;
+};
+
+std::mutex s_Mutex;
+std::vector<Section> s_Sections;
+
+Section &FindSection(const char *name) {
+  for (auto &s : s_Sections) {
+    if (s.Name == name || strcmp(s.Name, name) == 0)
+      return s;
+  }
+  s_Sections.emplace_back(name);
+  s_Sections.back().Samples.reserve(kWindowSize);
+  return s_Sections.back();
+}
+
+Profiler::SectionStats Compute(const Section &section) {
+  Profiler::SectionStats stats;
+  stats.Name = section.Name;
+  stats.Samples = section.Total;
+
+  std::vector<float> samples = section.Samples;
+  if (samples.empty())
+    return stats;
+  std::sort(samples.begin(), samples.end());
+  auto at = [&](float q) {
+    size_t idx = static_cast<size_t>(q * (samples.size() - 1) + 0.5f);
+    return samples[idx];
+  };
+  stats.P50 = at(0.50f);
+  stats.P95 = at(0.95f);
+  stats.P99 = at(0.99f);
+  stats.Max = samples.back();
+  return stats;
+}
+
+} // namespace
+
+void Profiler::Record(const char *section, double milliseconds) {
+  std::lock_guard<std::mutex> lock(s_Mutex);
+  Section &s = FindSection(section);
+  if (s.Samples.size() < kWindowSize)
+    s.Samples.push_back(static_cast<float>(milliseconds));
+  else
+    s.Samples[s.Next] = static_cast<float>(milliseconds);
+  s.Next = (s.Next + 1) % kWindowSize;
+  s.Total++;
+}
+
+void Profiler::Reset() {
+  std::lock_guard<std::mutex> lock(s_Mutex);
+  s_Sections.clear();
+}
+
+std::vector<Profiler::SectionStats> Profiler::GetStats() {
+  std::vector<Section> snapshot;
+  {
+    std::lock_guard<std::mutex> lock(s_Mutex);
+    snapshot = s_Sections;
+  }
+
+  std::vector<SectionStats> stats;
+  for (const auto &s : snapshot)
+    stats.push_back(Compute(s));
+  return stats;
+}
+
+bool Profiler::ExportCsv(const std::string &path) {
+  std::vector<SectionStats> stats = GetStats();
+
+  std::ofstream file(path);
+  if (!file.is_open())
+    return false;
+
+  file << "section,samples,p50_ms,p95_ms,p99_ms,max_ms\n";
+  for (const auto &s : stats) {
+    file << s.Name << "," << s.Samples << "," << s.P50 << "," << s.P95 << ","
+         << s.P99 << "," << s.Max << "\n";
+  }
+  return file.good();
+}
+
+#endif
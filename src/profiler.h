@@ -0,0 +1,62 @@
+#pragma once
+
+// Lightweight scoped timers for the render path. Enabled in debug builds (or
+// with TC_ENABLE_PROFILER=1); in release builds TC_PROFILE_SCOPE expands to
+// nothing and none of this is compiled.
+#ifndef TC_ENABLE_PROFILER
+#ifdef NDEBUG
+#define TC_ENABLE_PROFILER 0
+#else
+#define TC_ENABLE_PROFILER 1
+#endif
+#endif
+
+#if TC_ENABLE_PROFILER
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class Profiler {
+public:
+  // `section` must outlive the profiler (use string literals)
+  static void Record(const char *section, double milliseconds);
+  static void Reset();
+
+  struct SectionStats {
+    const char *Name = nullptr;
+    uint64_t Samples = 0; // Total recorded, not just the rolling window
+    float P50 = 0.0f, P95 = 0.0f, P99 = 0.0f, Max = 0.0f; // Milliseconds
+  };
+
+  // Percentiles over the rolling window of each section
+  static std::vector<SectionStats> GetStats();
+  static bool ExportCsv(const std::string &path);
+
+  class ScopedTimer {
+  public:
+    explicit ScopedTimer(const char *section)
+        : m_Section(section), m_Start(std::chrono::steady_clock::now()) {}
+    ~ScopedTimer() {
+      std::chrono::duration<double, std::milli> elapsed =
+          std::chrono::steady_clock::now() - m_Start;
+      Record(m_Section, elapsed.count());
+    }
+
+  private:
+    const char *m_Section;
+    std::chrono::steady_clock::time_point m_Start;
+  };
+};
+
+#define TC_PROFILE_CONCAT_INNER(a, b) a##b
+#define TC_PROFILE_CONCAT(a, b) TC_PROFILE_CONCAT_INNER(a, b)
+#define TC_PROFILE_SCOPE(section)                                              \
+  Profiler::ScopedTimer TC_PROFILE_CONCAT(tcProfileScope, __LINE__)(section)
+
+#else
+
+#define TC_PROFILE_SCOPE(section) ((void)0)
+
+#endif
@@ -0,0 +1,152 @@
+#include "spawn_alerts.h"
+#include "nlohmann_json.hpp"
+#include "platform.h"
+
+#include <algorithm>
+#include <cstdio>
+
+using json = nlohmann::json;
+
+static const char *kSettingsFile = "alerts.json";
+
+// Leads in [0, 12h], largest first so the alerts for one spawn arrive in
+// order, without repeats
+static void NormalizeLeads(std::vector<int> &leads) {
+  for (int &lead : leads)
+    lead = std::clamp(lead, 0, 720);
+  std::sort(leads.begin(), leads.end(), std::greater<int>());
+  leads.erase(std::unique(leads.begin(), leads.end()), leads.end());
+}
+
+SpawnAlerts::SpawnAlerts(const std::string &addonDir)
+    : m_Path(Platform::JoinPath(addonDir, kSettingsFile)) {}
+
+void SpawnAlerts::Load() {
+  Platform::MappedFile file;
+  if (!file.Open(m_Path))
+    return;
+  try {
+    json j = json::parse(file.View());
+    Settings settings;
+    settings.TrainSteps = j.value("trainSteps", settings.TrainSteps);
+    settings.LeadMinutes = j.value("leadMinutes", settings.LeadMinutes);
+    settings.PinnedEvents = j.value("pinned", settings.PinnedEvents);
+    NormalizeLeads(settings.LeadMinutes);
+    m_Settings = std::move(settings);
+    m_SettingsRevision++;
+  } catch (const std::exception &) {
+    // Keep the defaults; the file is rewritten on the next change
+  }
+}
+
+bool SpawnAlerts::Save() const {
+  json j = {{"trainSteps", m_Settings.TrainSteps},
+            {"leadMinutes", m_Settings.LeadMinutes},
+            {"pinned", m_Settings.PinnedEvents}};
+  return Platform::WriteFileAtomic(m_Path, j.dump(4));
+}
+
+void SpawnAlerts::SetSettings(Settings settings) {
+  NormalizeLeads(settings.LeadMinutes);
+  m_Settings = std::move(settings);
+  m_SettingsRevision++;
+  Save();
+}
+
+bool SpawnAlerts::IsPinned(const std::string &eventName) const {
+  const auto &pinned = m_Settings.PinnedEvents;
+  return std::find(pinned.begin(), pinned.end(), eventName) != pinned.end();
+}
+
+void SpawnAlerts::TogglePin(const std::string &eventName) {
+  Settings settings = m_Settings;
+  auto &pinned = settings.PinnedEvents;
+  auto it = std::find(pinned.begin(), pinned.end(), eventName);
+  if (it != pinned.end())
+    pinned.erase(it);
+  else
+    pinned.push_back(eventName);
+  SetSettings(std::move(settings));
+}
+
+int64_t SpawnAlerts::NextDeadline(int spawnMinute, int leadMinutes,
+                                  int64_t now) {
+  return FrameClock::NextDailyOccurrence((spawnMinute - leadMinutes) * 60,
+                                         now);
+}
+
+void SpawnAlerts::Sync(const TrainTemplate *train, uint64_t trainRevision,
+                       const EventCatalog *catalog, const FrameClock &clock) {
+  size_t trainSteps = train ? train->Steps.size() : 0;
+  uint64_t catalogRevision = catalog ? catalog->GetRevision() : 0;
+  if (train == m_Train && trainRevision == m_TrainRevision &&
+      trainSteps == m_TrainSteps && catalog == m_Catalog &&
+      catalogRevision == m_CatalogRevision &&
+      m_SettingsRevision == m_BuiltSettingsRevision)
+    return;
+  m_Train = train;
+  m_TrainRevision = trainRevision;
+  m_TrainSteps = trainSteps;
+  m_Catalog = catalog;
+  m_CatalogRevision = catalogRevision;
+  m_BuiltSettingsRevision = m_SettingsRevision;
+  Rebuild(train, catalog, clock);
+}
+
+void SpawnAlerts::Rebuild(const TrainTemplate *train,
+                          const EventCatalog *catalog,
+                          const FrameClock &clock) {
+  m_Targets.clear();
+  if (train && m_Settings.TrainSteps) {
+    for (const TrainStep &step : train->Steps) {
+      if (step.SpawnMinuteUTC >= 0)
+        m_Targets.push_back({step.Title, {step.SpawnMinuteUTC}});
+    }
+  }
+  if (catalog) {
+    for (const std::string &name : m_Settings.PinnedEvents) {
+      std::vector<int> minutes = catalog->GetSpawnMinutes(name);
+      if (!minutes.empty())
+        m_Targets.push_back({name, std::move(minutes)});
+    }
+  }
+
+  int64_t from = m_Updated ? std::min(m_LastUpdate, clock.EpochSeconds)
+                           : clock.EpochSeconds;
+  std::vector<Deadline> deadlines;
+  for (size_t t = 0; t < m_Targets.size(); ++t) {
+    for (int spawn : m_Targets[t].SpawnMinutes) {
+      for (int lead : m_Settings.LeadMinutes) {
+        deadlines.push_back({NextDeadline(spawn, lead, from),
+                             static_cast<int>(t), spawn, lead});
+      }
+    }
+  }
+  // Heapified in one go rather than pushed one by one
+  m_Heap = decltype(m_Heap)(std::greater<Deadline>(), std::move(deadlines));
+}
+
+void SpawnAlerts::Update(const FrameClock &clock,
+                         std::vector<std::string> &alerts) {
+  int64_t now = clock.EpochSeconds;
+  m_LastUpdate = now;
+  m_Updated = true;
+  while (!m_Heap.empty() && m_Heap.top().At <= now) {
+    Deadline deadline = m_Heap.top();
+    m_Heap.pop();
+    bool late = now - deadline.At > kMaxLatenessSeconds;
+    if (!late) {
+      char text[256];
+      if (deadline.LeadMinutes > 0)
+        snprintf(text, sizeof(text), "%s starts in %d minute%s",
+                 m_Targets[deadline.Target].Name.c_str(), deadline.LeadMinutes,
+                 deadline.LeadMinutes == 1 ? "" : "s");
+      else
+        snprintf(text, sizeof(text), "%s is starting now",
+                 m_Targets[deadline.Target].Name.c_str());
+      alerts.push_back(text);
+    }
+    deadline.At = NextDeadline(deadline.SpawnMinute, deadline.LeadMinutes, now);
+    m_Heap.push(deadline);
+  }
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include "event_catalog.h"
+#include "frame_clock.h"
+#include "train_types.h"
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <string>
+#include <vector>
+
+// Opt-in "starts in N minutes" alerts for the scheduled steps of the active
+// train and for pinned catalog events. Every spawn and lead time is one
+// deadline in a min-heap, so a frame only looks at the earliest; the heap
+// is rebuilt only when the train, the catalog snapshot or the settings
+// change, and a fired deadline is pushed back a day later.
+//
+// Settings live in alerts.json in the addon directory.
+class SpawnAlerts {
+public:
+  struct Settings {
+    bool TrainSteps = false; // Every scheduled step of the active train
+    std::vector<int> LeadMinutes = {5, 1};
+    std::vector<std::string> PinnedEvents; // Catalog event names
+  };
+
+  // Alerts more than this late (game paused, loading screen) are dropped
+  static const int kMaxLatenessSeconds = 30;
+
+  explicit SpawnAlerts(const std::string &addonDir);
+
+  void Load();
+  bool Save() const;
+
+  const Settings &GetSettings() const { return m_Settings; }
+  // Bumped by Load and SetSettings; lets views refresh text derived from
+  // the (normalized) settings
+  uint64_t GetSettingsRevision() const { return m_SettingsRevision; }
+  // Saves and reschedules
+  void SetSettings(Settings settings);
+  bool IsPinned(const std::string &eventName) const;
+  void TogglePin(const std::string &eventName);
+
+  // Rebuilds the deadlines if anything they come from changed, resuming
+  // from the last Update so nothing due since then is skipped. Either
+  // source may be null.
+  void Sync(const TrainTemplate *train, uint64_t trainRevision,
+            const EventCatalog *catalog, const FrameClock &clock);
+  // Appends the text of each alert that came due since the last call
+  void Update(const FrameClock &clock, std::vector<std::string> &alerts);
+
+  size_t GetPendingCount() const { return m_Heap.size(); }
+
+private:
+  // Something that spawns at fixed minutes of the day
+  struct Target {
+    std::string Name;
+    std::vector<int> SpawnMinutes;
+  };
+
+  struct Deadline {
+    int64_t At;
+    int Target;
+    int SpawnMinute;
+    int LeadMinutes;
+    bool operator>(const Deadline &other) const { return At > other.At; }
+  };
+
+  void Rebuild(const TrainTemplate *train, const EventCatalog *catalog,
+               const FrameClock &clock);
+  // First time after `now` an alert `leadMinutes` before the daily spawn
+  // at `spawnMinute` is due
+  static int64_t NextDeadline(int spawnMinute, int leadMinutes, int64_t now);
+
+  std::string m_Path;
+  Settings m_Settings;
+  uint64_t m_SettingsRevision = 1;
+
+  std::vector<Target> m_Targets;
+  std::priority_queue<Deadline, std::vector<Deadline>, std::greater<Deadline>>
+      m_Heap;
+  // What the heap was built from
+  const TrainTemplate *m_Train = nullptr;
+  uint64_t m_TrainRevision = 0;
+  size_t m_TrainSteps = 0;
+  const EventCatalog *m_Catalog = nullptr;
+  uint64_t m_CatalogRevision = 0;
+  uint64_t m_BuiltSettingsRevision = 0;
+  // Last second Update processed, where a rebuild resumes so a deadline due
+  // in the frame of an edit still fires; unset before the first Update
+  int64_t m_LastUpdate = 0;
+  bool m_Updated = false;
+};
@@ -0,0 +1,100 @@
+#include "timer_wheel.h"
+
+void TimerWheel::Schedule(int64_t deadline, uint64_t payload) {
+  Place({deadline, payload});
+  m_Pending++;
+}
+
+void TimerWheel::Place(const Timer &timer) {
+  int64_t delta = timer.Deadline - m_Now;
+  if (delta <= 0) {
+    m_Due.push_back(timer);
+    return;
+  }
+  for (int level = 0; level < kLevels; ++level) {
+    if (delta < (int64_t(1) << (kBits * (level + 1)))) {
+      int slot = (timer.Deadline >> (kBits * level)) & (kSlots - 1);
+      m_Wheels[level][slot].push_back(timer);
+      m_Counts[level]++;
+      return;
+    }
+  }
+  m_Overflow.push_back(timer);
+}
+
+void TimerWheel::Cascade(int level, int slot) {
+  Slot &timers = level == kLevels ? m_Overflow : m_Wheels[level][slot];
+  if (level < kLevels)
+    m_Counts[level] -= timers.size();
+  // Place may append to this very slot, so move the timers out first
+  m_Scratch.swap(timers);
+  for (const Timer &timer : m_Scratch)
+    Place(timer);
+  m_Scratch.clear();
+}
+
+void TimerWheel::Advance(int64_t now, std::vector<uint64_t> &fired) {
+  for (const Timer &timer : m_Due)
+    fired.push_back(timer.Payload);
+  m_Pending -= m_Due.size();
+  m_Due.clear();
+
+  if (m_Pending == 0 && now > m_Now) {
+    m_Now = now; // Nothing to walk past
+    return;
+  }
+
+  while (m_Now < now) {
+    // While the lowest levels are empty nothing happens before the current
+    // span of the first non-empty level ends
+    int empty = 0;
+    while (empty < kLevels && m_Counts[empty] == 0)
+      empty++;
+    if (empty > 0) {
+      int64_t spanEnd = m_Now | ((int64_t(1) << (kBits * empty)) - 1);
+      if (spanEnd >= now) {
+        m_Now = now;
+        break;
+      }
+      m_Now = spanEnd;
+    }
+
+    m_Now++;
+    // Entering a new span of a higher level moves its timers down first
+    for (int level = 1; level <= kLevels; ++level) {
+      if (m_Now & ((int64_t(1) << (kBits * level)) - 1))
+        break;
+      Cascade(level, (m_Now >> (kBits * level)) & (kSlots - 1));
+    }
+
+    // Everything in this slot is due exactly now, as is anything the
+    // cascades above put into m_Due
+    Slot &current = m_Wheels[0][m_Now & (kSlots - 1)];
+    for (const Timer &timer : current)
+      fired.push_back(timer.Payload);
+    m_Pending -= current.size();
+    m_Counts[0] -= current.size();
+    current.clear();
+    for (const Timer &timer : m_Due)
+      fired.push_back(timer.Payload);
+    m_Pending -= m_Due.size();
+    m_Due.clear();
+
+    if (m_Pending == 0) {
+      m_Now = now;
+      break;
+    }
+  }
+}
+
+void TimerWheel::Reset(int64_t now) {
+  for (auto &wheel : m_Wheels) {
+    for (Slot &slot : wheel)
+      slot.clear();
+  }
+  m_Due.clear();
+  m_Overflow.clear();
+  m_Counts.fill(0);
+  m_Pending = 0;
+  m_Now = now;
+}
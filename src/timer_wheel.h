@@ -0,0 +1,52 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Hierarchical timing wheel over integer ticks (the callers use seconds).
+// Three levels of 64 slots cover deadlines up to 64^3 ticks ahead, about
+// three days of seconds; later ones wait in an overflow list. Scheduling is
+// O(1), and advancing costs O(1) per tick plus the timers that fire or move
+// down a level, however many are pending; spans of empty levels are skipped
+// whole.
+class TimerWheel {
+public:
+  explicit TimerWheel(int64_t now = 0) : m_Now(now) {}
+
+  // `payload` is returned by Advance once the wheel reaches `deadline`.
+  // Deadlines at or before the current tick fire on the next Advance.
+  void Schedule(int64_t deadline, uint64_t payload);
+  // Moves to tick `now`, appending the payloads of expired timers to
+  // `fired` in deadline order. Going backwards does nothing.
+  void Advance(int64_t now, std::vector<uint64_t> &fired);
+  // Drops every timer and restarts at `now`
+  void Reset(int64_t now);
+
+  int64_t GetNow() const { return m_Now; }
+  size_t GetPendingCount() const { return m_Pending; }
+
+private:
+  static const int kBits = 6;
+  static const int kSlots = 1 << kBits;
+  static const int kLevels = 3;
+
+  struct Timer {
+    int64_t Deadline;
+    uint64_t Payload;
+  };
+  using Slot = std::vector<Timer>;
+
+  // Files a timer by its distance from m_Now
+  void Place(const Timer &timer);
+  // Re-files the timers of slot `slot` of `level` (kLevels = overflow)
+  void Cascade(int level, int slot);
+
+  int64_t m_Now;
+  size_t m_Pending = 0;
+  std::array<std::array<Slot, kSlots>, kLevels> m_Wheels;
+  std::array<size_t, kLevels> m_Counts{}; // Timers per level
+  Slot m_Due;      // Scheduled at or before m_Now
+  Slot m_Overflow; // Beyond the last level
+  Slot m_Scratch;  // Reused by Cascade
+};
@@ -0,0 +1,50 @@
+#include "token_bucket.h"
+
+#include <algorithm>
+
+TokenBucket::TokenBucket(int capacity, Clock::duration interval)
+    : m_Capacity(std::max(1, capacity)), m_Interval(interval),
+      m_Tokens(m_Capacity) {}
+
+void TokenBucket::Refill(Clock::time_point now, int &tokens,
+                         Clock::time_point &credited) const {
+  tokens = m_Tokens;
+  credited = m_Credited;
+  if (tokens >= m_Capacity || now <= credited)
+    return;
+  auto earned = (now - credited) / m_Interval;
+  if (earned >= m_Capacity - tokens) {
+    tokens = m_Capacity;
+    credited = now;
+  } else {
+    // Keep the partial interval so refills stay on schedule
+    tokens += static_cast<int>(earned);
+    credited += earned * m_Interval;
+  }
+}
+
+bool TokenBucket::TryTake(Clock::time_point now) {
+  Refill(now, m_Tokens, m_Credited);
+  if (m_Tokens == 0)
+    return false;
+  // A full bucket starts counting the next refill from here
+  if (m_Tokens == m_Capacity)
+    m_Credited = now;
+  m_Tokens--;
+  return true;
+}
+
+TokenBucket::Clock::time_point
+TokenBucket::NextAvailable(Clock::time_point now) const {
+  int tokens;
+  Clock::time_point credited;
+  Refill(now, tokens, credited);
+  return tokens > 0 ? now : credited + m_Interval;
+}
+
+int TokenBucket::GetAvailable(Clock::time_point now) const {
+  int tokens;
+  Clock::time_point credited;
+  Refill(now, tokens, credited);
+  return tokens;
+}
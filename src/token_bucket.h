@@ -0,0 +1,28 @@
+#pragma once
+#include <chrono>
+
+// Classic token bucket: holds up to `capacity` tokens and regains one every
+// `interval`. Starts full, so a burst of `capacity` goes through at once
+// and anything beyond that is paced at the refill rate.
+class TokenBucket {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  TokenBucket(int capacity, Clock::duration interval);
+
+  // Takes a token if one is available at `now`
+  bool TryTake(Clock::time_point now);
+  // Earliest time at or after `now` when TryTake succeeds
+  Clock::time_point NextAvailable(Clock::time_point now) const;
+  int GetAvailable(Clock::time_point now) const;
+
+private:
+  // Tokens and the time the last one was credited, advanced to `now`
+  void Refill(Clock::time_point now, int &tokens,
+              Clock::time_point &credited) const;
+
+  int m_Capacity;
+  Clock::duration m_Interval;
+  int m_Tokens;
+  Clock::time_point m_Credited; // Unset until the first TryTake
+};
@@ -0,0 +1,365 @@
+#include "train_codec.h"
+#include "base64.h"
+#include "lz_codec.h"
+#include "train_reader.h"
+#include "train_schema.h"
+
+#include <cstring>
+#include <stdexcept>
+
+using json = nlohmann::json;
+
+namespace {
+
+template <typename T> struct IsVector : std::false_type {};
+template <typename T> struct IsVector<std::vector<T>> : std::true_type {};
+
+// ---- JSON ----
+
+template <typename T> json ObjectToJson(const T &obj);
+
+template <typename M> json ValueToJson(const M &value) {
+  if constexpr (std::is_enum_v<M>) {
+    return static_cast<int>(value);
+  } else if constexpr (IsVector<M>::value) {
+    json array = json::array();
+    for (const auto &element : value)
+      array.push_back(ObjectToJson(element));
+    return array;
+  } else {
+    return value;
+  }
+}
+
+template <typename T> json ObjectToJson(const T &obj) {
+  json j = json::object();
+  TrainSchema::ForEachField<T>(
+      [&](const auto &field) { j[field.Name] = ValueToJson(obj.*field.Ptr); });
+  return j;
+}
+
+template <typename T> void ObjectFromJson(const json &j, T &obj);
+
+template <typename M> void ValueFromJson(const json &j, M &value) {
+  if constexpr (std::is_enum_v<M>) {
+    value = static_cast<M>(j.get<int>());
+  } else if constexpr (IsVector<M>::value) {
+    if (!j.is_array())
+      return; // Lists of another type are ignored, as they always were
+    value.clear();
+    value.reserve(j.size());
+    for (const auto &jElement : j) {
+      typename M::value_type element;
+      TrainSchema::ResetToDefaults(element);
+      ObjectFromJson(jElement, element);
+      value.push_back(std::move(element));
+    }
+  } else {
+    value = j.get<M>();
+  }
+}
+
+template <typename T> void ObjectFromJson(const json &j, T &obj) {
+  if (!j.is_object())
+    throw std::invalid_argument("expected a JSON object");
+  TrainSchema::ForEachField<T>([&](const auto &field) {
+    auto it = j.find(field.Name);
+    if (it != j.end())
+      ValueFromJson(*it, obj.*field.Ptr);
+  });
+}
+
+// ---- Binary ----
+
+const char kBinaryMagic[4] = {'T', 'C', 'B', '1'};
+
+const char kSharePrefix[] = "TC2.";
+const size_t kSharePrefixLength = sizeof(kSharePrefix) - 1;
+// Decompressed share strings larger than this are rejected unread
+const uint64_t kMaxShareBytes = 16 * 1024 * 1024;
+// Legacy share strings are decoded into the parser this much text at a time
+const size_t kShareChunk = 4096;
+
+bool ShareError(std::string *error, const std::string &message) {
+  if (error)
+    *error = message;
+  return false;
+}
+
+// `base` is where the decoded text starts in the pasted string
+bool ShareError(std::string *error, const Base64Decoder &decoder,
+                size_t base) {
+  return ShareError(error,
+                    std::string(Base64Decoder::StatusText(decoder.GetStatus())) +
+                        " at offset " +
+                        std::to_string(base + decoder.GetErrorOffset()));
+}
+
+class BinaryWriter {
+public:
+  explicit BinaryWriter(std::string &out) : m_Out(out) {}
+
+  void Varint(uint64_t value) {
+    while (value >= 0x80) {
+      m_Out.push_back(static_cast<char>(value | 0x80));
+      value >>= 7;
+    }
+    m_Out.push_back(static_cast<char>(value));
+  }
+
+  template <typename T> void Object(const T &obj) {
+    TrainSchema::ForEachField<T>(
+        [&](const auto &field) { Value(obj.*field.Ptr); });
+  }
+
+private:
+  template <typename M> void Value(const M &value) {
+    if constexpr (std::is_same_v<M, std::string>) {
+      Varint(value.size());
+      m_Out.append(value);
+    } else if constexpr (IsVector<M>::value) {
+      Varint(value.size());
+      for (const auto &element : value)
+        Object(element);
+    } else {
+      // Zigzag so small negatives (SpawnMinuteUTC = -1) stay one byte
+      int64_t v = static_cast<int64_t>(value);
+      Varint((static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63));
+    }
+  }
+
+  std::string &m_Out;
+};
+
+class BinaryReader {
+public:
+  BinaryReader(const char *begin, const char *end) : m_Pos(begin), m_End(end) {}
+
+  bool Varint(uint64_t &value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      if (m_Pos == m_End)
+        return false;
+      uint8_t byte = static_cast<uint8_t>(*m_Pos++);
+      value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+      if (!(byte & 0x80))
+        return true;
+    }
+    return false;
+  }
+
+  template <typename T> bool Object(T &obj) {
+    bool ok = true;
+    TrainSchema::ForEachField<T>([&](const auto &field) {
+      ok = ok && Value(obj.*field.Ptr);
+    });
+    return ok;
+  }
+
+  bool AtEnd() const { return m_Pos == m_End; }
+  std::string_view Rest() const {
+    return {m_Pos, static_cast<size_t>(m_End - m_Pos)};
+  }
+
+private:
+  template <typename M> bool Value(M &value) {
+    uint64_t raw;
+    if (!Varint(raw))
+      return false;
+    if constexpr (std::is_same_v<M, std::string>) {
+      if (raw > static_cast<uint64_t>(m_End - m_Pos))
+        return false;
+      value.assign(m_Pos, static_cast<size_t>(raw));
+      m_Pos += raw;
+      return true;
+    } else if constexpr (IsVector<M>::value) {
+      // Grown element by element so a corrupt count fails at the end of
+      // the data instead of allocating up front
+      value.clear();
+      for (uint64_t i = 0; i < raw; ++i) {
+        value.emplace_back();
+        if (!Object(value.back()))
+          return false;
+      }
+      return true;
+    } else {
+      int64_t v = static_cast<int64_t>(raw >> 1) ^ -static_cast<int64_t>(raw & 1);
+      value = static_cast<M>(v);
+      return true;
+    }
+  }
+
+  const char *m_Pos;
+  const char *m_End;
+};
+
+} // namespace
+
+json TrainCodec::ToJson(const TrainTemplate &train) {
+  return ObjectToJson(train);
+}
+
+json TrainCodec::ToJson(const TrainStep &step) { return ObjectToJson(step); }
+
+void TrainCodec::HeaderToJson(const TrainTemplate &train, json &out) {
+  TrainSchema::ForEachHeaderField<TrainTemplate>([&](const auto &field) {
+    out[field.Name] = ValueToJson(train.*field.Ptr);
+  });
+}
+
+void TrainCodec::FromJson(const json &j, TrainTemplate &out) {
+  ObjectFromJson(j, out);
+}
+
+void TrainCodec::FromJson(const json &j, TrainStep &out) {
+  ObjectFromJson(j, out);
+}
+
+void TrainCodec::HeaderFromJson(const json &j, TrainTemplate &out) {
+  TrainSchema::ForEachHeaderField<TrainTemplate>([&](const auto &field) {
+    auto it = j.find(field.Name);
+    if (it != j.end())
+      ValueFromJson(*it, out.*field.Ptr);
+  });
+}
+
+std::string TrainCodec::ToJsonText(const TrainTemplate &train, bool pretty) {
+  return ObjectToJson(train).dump(pretty ? 4 : -1);
+}
+
+std::string TrainCodec::Encode(const TrainTemplate &train,
+                               TrainFormat format) {
+  std::string out;
+  switch (format) {
+  case TrainFormat::PrettyJson:
+    return ToJsonText(train, true);
+  case TrainFormat::CompactJson:
+    return ToJsonText(train, false);
+  case TrainFormat::Cbor:
+    json::to_cbor(ObjectToJson(train), out);
+    break;
+  case TrainFormat::MsgPack:
+    json::to_msgpack(ObjectToJson(train), out);
+    break;
+  }
+  return out;
+}
+
+bool TrainCodec::Decode(std::string_view data, TrainFormat format,
+                        TrainTemplate &out) {
+  return TrainReader::ReadTrain(data, out, format);
+}
+
+namespace {
+
+struct FormatInfo {
+  TrainFormat Format;
+  const char *Name;
+  const char *Extension;
+};
+
+const FormatInfo kFormats[] = {
+    {TrainFormat::PrettyJson, "json-pretty", "json"},
+    {TrainFormat::CompactJson, "json", "json"},
+    {TrainFormat::Cbor, "cbor", "cbor"},
+    {TrainFormat::MsgPack, "msgpack", "msgpack"},
+};
+
+} // namespace
+
+const char *TrainCodec::FormatName(TrainFormat format) {
+  return kFormats[static_cast<int>(format)].Name;
+}
+
+bool TrainCodec::FormatFromName(const std::string &name, TrainFormat &format) {
+  for (const auto &info : kFormats) {
+    if (name == info.Name) {
+      format = info.Format;
+      return true;
+    }
+  }
+  return false;
+}
+
+const char *TrainCodec::FormatExtension(TrainFormat format) {
+  return kFormats[static_cast<int>(format)].Extension;
+}
+
+std::string TrainCodec::ToBinary(const TrainTemplate &train) {
+  std::string out(kBinaryMagic, sizeof(kBinaryMagic));
+  BinaryWriter(out).Object(train);
+  return out;
+}
+
+bool TrainCodec::FromBinary(const std::string &data, TrainTemplate &out) {
+  if (data.size() < sizeof(kBinaryMagic) ||
+      memcmp(data.data(), kBinaryMagic, sizeof(kBinaryMagic)) != 0)
+    return false;
+
+  TrainTemplate train;
+  train.Id = out.Id;
+  BinaryReader reader(data.data() + sizeof(kBinaryMagic),
+                      data.data() + data.size());
+  if (!reader.Object(train) || !reader.AtEnd())
+    return false;
+  out = std::move(train);
+  return true;
+}
+
+std::string TrainCodec::ToShareString(const TrainTemplate &train) {
+  std::string text = ToJsonText(train, false);
+  std::string payload;
+  BinaryWriter(payload).Varint(text.size());
+  payload += LzCodec::Compress(text);
+  return kSharePrefix + Base64::EncodeUrl(payload);
+}
+
+bool TrainCodec::FromShareString(const std::string &text, TrainTemplate &out,
+                                 std::string *error) {
+  size_t begin = text.find_first_not_of(" \t\r\n");
+  if (begin == std::string::npos)
+    return ShareError(error, "clipboard is empty");
+
+  if (text.compare(begin, kSharePrefixLength, kSharePrefix) != 0) {
+    // Legacy: the JSON is decoded straight into the parser chunk by chunk
+    Base64Decoder decoder;
+    std::string_view rest = std::string_view(text).substr(begin);
+    std::string chunk;
+    bool finished = false;
+    bool parsed = TrainReader::ReadTrain(
+        [&]() -> std::string_view {
+          chunk.clear();
+          while (chunk.empty() && !finished) {
+            if (rest.empty()) {
+              finished = true;
+              decoder.Finish(chunk);
+            } else if (!decoder.Feed(rest.substr(0, kShareChunk), chunk)) {
+              finished = true;
+              chunk.clear();
+            } else {
+              rest.remove_prefix(std::min(rest.size(), kShareChunk));
+            }
+          }
+          return chunk;
+        },
+        out);
+    if (decoder.GetStatus() != Base64Decoder::Status::Ok)
+      return ShareError(error, decoder, begin);
+    return parsed || ShareError(error, "share string is damaged");
+  }
+
+  Base64Decoder decoder(true);
+  std::string payload;
+  size_t payloadBegin = begin + kSharePrefixLength;
+  if (!decoder.Feed(std::string_view(text).substr(payloadBegin), payload) ||
+      !decoder.Finish(payload))
+    return ShareError(error, decoder, payloadBegin);
+  BinaryReader reader(payload.data(), payload.data() + payload.size());
+  uint64_t size;
+  std::string decoded;
+  if (!reader.Varint(size) || size > kMaxShareBytes ||
+      !LzCodec::Decompress(reader.Rest(), static_cast<size_t>(size), decoded))
+    return ShareError(error, "share string is damaged");
+  return TrainReader::ReadTrain(decoded, out) ||
+         ShareError(error, "share string is damaged");
+}
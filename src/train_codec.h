@@ -0,0 +1,57 @@
+#pragma once
+#include "nlohmann_json.hpp"
+#include "train_types.h"
+#include <string>
+#include <string_view>
+
+// On-disk encodings of a train. The JSON forms are text; CBOR and
+// MessagePack are nlohmann's binary encodings of the same document.
+enum class TrainFormat { PrettyJson, CompactJson, Cbor, MsgPack };
+
+// Train serializers generated from TrainSchema. The JSON forms keep the key
+// names of the original hand-written mapping, so existing libraries and
+// share strings read back unchanged.
+//
+// Readers leave fields missing from the input at the value `out` already
+// holds; nested steps and messages start from the schema defaults.
+class TrainCodec {
+public:
+  using json = nlohmann::json;
+
+  static json ToJson(const TrainTemplate &train);
+  static json ToJson(const TrainStep &step);
+  // Every field but the steps, merged into `out`
+  static void HeaderToJson(const TrainTemplate &train, json &out);
+
+  // Throw on malformed input (wrong field types, non-object records)
+  static void FromJson(const json &j, TrainTemplate &out);
+  static void FromJson(const json &j, TrainStep &out);
+  static void HeaderFromJson(const json &j, TrainTemplate &out);
+
+  // Pretty is the 4-space layout of the original trains.json
+  static std::string ToJsonText(const TrainTemplate &train, bool pretty);
+
+  static std::string Encode(const TrainTemplate &train, TrainFormat format);
+  static bool Decode(std::string_view data, TrainFormat format,
+                     TrainTemplate &out);
+  // Stable identifiers for the index file and the options UI
+  static const char *FormatName(TrainFormat format);
+  static bool FormatFromName(const std::string &name, TrainFormat &format);
+  // File extension (without the dot) of shards in this format
+  static const char *FormatExtension(TrainFormat format);
+
+  // Schema-ordered fields without keys: varint integers, length-prefixed
+  // strings and lists. Only readable by the same schema version.
+  static std::string ToBinary(const TrainTemplate &train);
+  static bool FromBinary(const std::string &data, TrainTemplate &out);
+
+  // Text exchanged through the clipboard: "TC2." then base64url of the
+  // compact JSON's length (varint) and its LzCodec block. The reader also
+  // accepts the original format, plain Base64 of the compact JSON, which
+  // never contains a '.'.
+  // Whitespace inside the text (line breaks added by chat) is ignored. On
+  // failure `error`, if given, says what was wrong and where.
+  static std::string ToShareString(const TrainTemplate &train);
+  static bool FromShareString(const std::string &text, TrainTemplate &out,
+                              std::string *error = nullptr);
+};
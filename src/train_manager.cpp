@@ -1,106 +1,859 @@
 #include "train_manager.h"
-#include "base64.h"
 #include "nlohmann_json.hpp"
+#include "platform.h"
+#include "profiler.h"
+#include "train_codec.h"
+#include "train_reader.h"
+#include "train_schema.h"
 
-#include <fstream>
-#include <windows.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <functional>
+#include <random>
+#include <set>
+#include <stdexcept>
 
 using json = nlohmann::json;
 
+// Library layout under <addon>/trains/:
+//   index.json        generation plus one header record per train, in order
+//   <id>-<hash>.<ext> one train per shard, in the storage format named by
+//                     the index; named after its content, so a shard is
+//                     never rewritten in place and an index always points at
+//                     complete files
+//   journal.jsonl     edits on top of the index generation
+static const char *kLibraryDir = "trains";
+static const char *kIndexFile = "index.json";
+static const char *kJournalFile = "journal.jsonl";
+
+// Journal lines beyond which the next save compacts into shards
+static const size_t kJournalMaxBytes = 256 * 1024;
+// Diffs touching more records than this are cheaper as a full rewrite
+static const size_t kJournalMaxOps = 64;
+
+// FNV-1a; only used to name shards and spot changed content
+static uint64_t HashBytes(std::string_view data) {
+  uint64_t hash = 14695981039346656037ull;
+  for (unsigned char c : data) {
+    hash ^= c;
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+static std::string ToHex(uint64_t value) {
+  char buf[17];
+  snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(value));
+  return buf;
+}
+
+// Format of a shard file going by its extension; false for anything else
+// in the library directory (.tmp and .corrupt leftovers, the journal)
+static bool ShardFormat(const std::string &name, TrainFormat &format) {
+  size_t dot = name.rfind('.');
+  if (dot == std::string::npos || name == kIndexFile)
+    return false;
+  std::string extension = name.substr(dot + 1);
+  for (TrainFormat candidate : {TrainFormat::PrettyJson, TrainFormat::Cbor,
+                                TrainFormat::MsgPack}) {
+    if (extension == TrainCodec::FormatExtension(candidate)) {
+      format = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+static std::string NewTrainId() {
+  static std::mt19937_64 rng{std::random_device{}()};
+  return ToHex(rng());
+}
+
+// Appends journal records turning `before` into `after`. Returns false when
+// the change is too large to be worth journaling. Ids of the trains the
+// records touch are added to `touched`. `loadBody` reads a header-only
+// train's steps from its shard so a body loaded since the last save can be
+// diffed step by step.
+static bool
+DiffToJournal(const std::vector<TrainTemplate> &before,
+              const std::vector<TrainTemplate> &after, std::string &out,
+              std::set<std::string> &touched,
+              const std::function<bool(TrainTemplate &)> &loadBody) {
+  std::vector<json> ops;
+  std::set<std::string> ids;
+  auto add = [&](json op) {
+    ops.push_back(std::move(op));
+    return ops.size() <= kJournalMaxOps;
+  };
+
+  // Removed trains become records of their own so the trains behind them
+  // don't shift into a positional diff
+  std::set<std::string> afterIds;
+  for (const auto &train : after)
+    afterIds.insert(train.Id);
+  std::vector<const TrainTemplate *> base;
+  for (const auto &train : before)
+    base.push_back(&train);
+  for (size_t t = base.size(); t-- > 0;) {
+    if (afterIds.count(base[t]->Id))
+      continue;
+    base.erase(base.begin() + t);
+    if (!add({{"op", "remove"}, {"t", t}}))
+      return false;
+  }
+
+  for (size_t t = 0; t < after.size(); ++t) {
+    const auto &b = after[t];
+    if (t >= base.size()) {
+      json op = {{"op", "train"}, {"t", t}, {"id", b.Id}};
+      op["v"] = TrainCodec::ToJson(b);
+      ids.insert(b.Id);
+      if (!add(op))
+        return false;
+      continue;
+    }
+
+    const TrainTemplate *prev = base[t];
+    TrainTemplate shard;
+    if (!prev->StepsLoaded && b.StepsLoaded) {
+      shard = *prev;
+      if (!loadBody(shard)) {
+        // No old body to diff against; journal the whole train
+        json op = {{"op", "train"}, {"t", t}, {"id", b.Id}};
+        op["v"] = TrainCodec::ToJson(b);
+        ids.insert(b.Id);
+        if (!add(op))
+          return false;
+        continue;
+      }
+      prev = &shard;
+    }
+
+    const auto &a = *prev;
+    size_t opsBefore = ops.size();
+    if (a.Name != b.Name || a.Author != b.Author || a.Type != b.Type) {
+      json op = {{"op", "meta"}, {"t", t}};
+      TrainCodec::HeaderToJson(b, op);
+      if (!add(op))
+        return false;
+    }
+    // A body that is not resident on either side is unchanged: bodies are
+    // only dropped once their shard is current
+    for (size_t i = 0; a.StepsLoaded && b.StepsLoaded && i < b.Steps.size();
+         ++i) {
+      if (i < a.Steps.size() && a.Steps[i] == b.Steps[i])
+        continue;
+      json op = {{"op", "step"}, {"t", t}, {"s", i}};
+      op["v"] = TrainCodec::ToJson(b.Steps[i]);
+      if (!add(op))
+        return false;
+    }
+    if (a.StepsLoaded && b.StepsLoaded && b.Steps.size() < a.Steps.size()) {
+      if (!add({{"op", "steps"}, {"t", t}, {"n", b.Steps.size()}}))
+        return false;
+    }
+    if (ops.size() != opsBefore)
+      ids.insert(b.Id);
+  }
+  if (after.size() < base.size()) {
+    if (!add({{"op", "trains"}, {"n", after.size()}}))
+      return false;
+  }
+
+  for (const auto &op : ops)
+    out += op.dump() + "\n";
+  touched.insert(ids.begin(), ids.end());
+  return true;
+}
+
+// Applies one journal record; throws on malformed input. Ids of the trains
+// it modified are added to `touched`; `load` brings in a header-only
+// train's body before a record is applied to it, and the record throws too
+// if the body stays out of memory.
+static void ApplyJournalOp(const json &op, std::vector<TrainTemplate> &trains,
+                           std::set<std::string> &touched,
+                           const std::function<void(TrainTemplate &)> &load) {
+  std::string kind = op.at("op").get<std::string>();
+  if (kind == "trains") {
+    size_t n = op.at("n").get<size_t>();
+    if (n < trains.size())
+      trains.resize(n);
+    return;
+  }
+
+  size_t t = op.at("t").get<size_t>();
+  if (kind == "remove") {
+    if (t >= trains.size())
+      throw std::out_of_range("journal train index");
+    trains.erase(trains.begin() + t);
+    return;
+  }
+  if (kind == "train") {
+    if (t > trains.size())
+      throw std::out_of_range("journal train index");
+    TrainTemplate train;
+    TrainSchema::ResetToDefaults(train);
+    TrainCodec::FromJson(op.at("v"), train);
+    train.Id = op.value("id", ""); // Missing in legacy journals
+    touched.insert(train.Id);
+    if (t == trains.size())
+      trains.push_back(std::move(train));
+    else
+      trains[t] = std::move(train);
+    return;
+  }
+
+  TrainTemplate &train = trains.at(t);
+  if (!train.StepsLoaded)
+    load(train);
+  if (!train.StepsLoaded)
+    throw std::runtime_error("journal train body unreadable");
+  if (kind == "meta") {
+    TrainCodec::HeaderFromJson(op, train);
+  } else if (kind == "step") {
+    size_t i = op.at("s").get<size_t>();
+    if (i > train.Steps.size())
+      throw std::out_of_range("journal step index");
+    TrainStep step;
+    TrainSchema::ResetToDefaults(step);
+    TrainCodec::FromJson(op.at("v"), step);
+    if (i == train.Steps.size())
+      train.Steps.push_back(std::move(step));
+    else
+      train.Steps[i] = std::move(step);
+  } else if (kind == "steps") {
+    size_t n = op.at("n").get<size_t>();
+    if (n < train.Steps.size())
+      train.Steps.resize(n);
+  } else {
+    throw std::invalid_argument("unknown journal op");
+  }
+  touched.insert(train.Id);
+}
+
+// Replays the journal written on top of base `generation`. Returns the size
+// of its intact prefix, or 0 if it is missing or belongs to another base.
+// `clean` is cleared when a torn line (crash mid-append) ended the replay;
+// everything before it is kept.
+static size_t
+ReplayJournal(const std::string &path, uint64_t generation,
+              std::vector<TrainTemplate> &trains,
+              std::set<std::string> &touched, bool &clean,
+              const std::function<void(TrainTemplate &)> &load) {
+  clean = true;
+  Platform::MappedFile file;
+  if (!file.Open(path))
+    return 0;
+  std::string_view journal = file.View();
+
+  size_t pos = 0;
+  bool first = true;
+  while (pos < journal.size()) {
+    size_t end = journal.find('\n', pos);
+    if (end == std::string_view::npos) {
+      clean = false;
+      break;
+    }
+    try {
+      json op = json::parse(journal.begin() + pos, journal.begin() + end);
+      if (first) {
+        if (op.value("op", "") != "base" ||
+            op.value("generation", 0ull) != generation)
+          break; // Journal belongs to an older base; ignore it
+        first = false;
+      } else {
+        ApplyJournalOp(op, trains, touched, load);
+      }
+    } catch (...) {
+      clean = false;
+      break;
+    }
+    pos = end + 1;
+  }
+  return pos;
+}
+
 TrainManager::TrainManager(const std::string &addonDir) : m_AddonDir(addonDir) {
-  m_ConfigPath = m_AddonDir + "\\trains.json";
+  m_LibraryDir = Platform::JoinPath(m_AddonDir, kLibraryDir);
+  m_IndexPath = Platform::JoinPath(m_LibraryDir, kIndexFile);
+  m_JournalPath = Platform::JoinPath(m_LibraryDir, kJournalFile);
+}
+
+TrainManager::~TrainManager() {
+  {
+    std::lock_guard<std::mutex> lock(m_SaveMutex);
+    m_StopWorker = true;
+  }
+  m_SaveCv.notify_all();
+  if (m_SaveThread.joinable())
+    m_SaveThread.join();
 }
 
 void TrainManager::LoadTrains() {
-  std::ifstream file(m_ConfigPath);
-  if (!file.is_open())
+  std::vector<TrainTemplate> trains;
+  std::map<std::string, LibraryEntry> index;
+  uint64_t generation = 0;
+  IndexStatus status = LoadIndex(trains, index, generation);
+  if (status == IndexStatus::Unreadable) {
+    // Saving now would replace a library we never saw
+    m_ReadOnly = true;
     return;
+  }
+  if (status != IndexStatus::Loaded) {
+    if (RecoverIndex(trains, index)) {
+      // Journal records address trains by position, which the rebuilt order
+      // does not match; keep the journal for inspection instead of replaying
+      Platform::MappedFile journal;
+      if (journal.Open(m_JournalPath) &&
+          Platform::WriteFileAtomic(m_JournalPath + ".corrupt",
+                                    std::string(journal.View()))) {
+        journal.Close(); // Windows refuses to delete a mapped file
+        Platform::RemoveFile(m_JournalPath);
+      }
 
-  try {
-    json j;
-    file >> j;
-
-    m_Trains.clear();
-    for (const auto &jTrain : j["trains"]) {
-      TrainTemplate train;
-      train.Name = jTrain.value("Name", "Unnamed Train");
-      train.Author = jTrain.value("Author", "Unknown");
-      train.Type =
-          static_cast<TrainType>(jTrain.value("Type", 2)); // Default to Mixed
-
-      for (const auto &jStep : jTrain["steps"]) {
-        TrainStep step;
-        step.Title = jStep.value("Title", "Step");
-        step.Description = jStep.value("Description", "");
-        step.WaypointCode = jStep.value("WaypointCode", "");
-        step.SquadMessage = jStep.value("SquadMessage", "");
-        step.Mechanics = jStep.value("Mechanics", "");
-        step.SpawnMinuteUTC = jStep.value("SpawnMinuteUTC", -1);
-        step.DurationMinutes = jStep.value("DurationMinutes", 0);
-        if (jStep.contains("CustomMessages") && jStep["CustomMessages"].is_array()) {
-          for (const auto &msgObj : jStep["CustomMessages"]) {
-            CustomMessage msg;
-            msg.title = msgObj.value("title", "");
-            msg.text = msgObj.value("text", "");
-            step.CustomMessages.push_back(msg);
-          }
-        }
-        train.Steps.push_back(step);
+      std::lock_guard<std::mutex> lock(m_WriteMutex);
+      {
+        std::lock_guard<std::mutex> indexLock(m_IndexMutex);
+        m_Index = std::move(index);
       }
-      m_Trains.push_back(train);
+      m_Trains = trains;
+      m_Persisted = std::move(trains);
+      m_JournalBytes = 0; // The next save compacts into a fresh index
+      m_KeepUnlistedShards = true;
+      MarkDirty();
+    } else if (Platform::FileExists(
+                   Platform::JoinPath(m_AddonDir, "trains.json"))) {
+      MigrateLegacyLibrary();
     }
-  } catch (...) {
+    EvictBodies();
+    return;
   }
+
+  {
+    std::lock_guard<std::mutex> lock(m_WriteMutex);
+    {
+      std::lock_guard<std::mutex> indexLock(m_IndexMutex);
+      m_Index = std::move(index);
+    }
+
+    // Only trains with journal records get their bodies loaded here
+    bool journalClean = true;
+    bool bodyUnreadable = false;
+    std::set<std::string> touched;
+    size_t journalBytes = ReplayJournal(
+        m_JournalPath, generation, trains, touched, journalClean,
+        [this, &bodyUnreadable](TrainTemplate &train) {
+          bodyUnreadable = !LoadBody(train) && !train.StepsLoaded;
+        });
+    AssignIds(trains);
+    // The rest of the journal could not be applied; compacting now would
+    // throw those records away, so leave every file as it is
+    if (bodyUnreadable)
+      m_ReadOnly = true;
+
+    m_Trains = trains;
+    m_QueuedRevision = m_Revision;
+    m_Lru.clear();
+    for (const auto &train : m_Trains) {
+      if (train.StepsLoaded)
+        m_Lru.push_back(train.Id);
+    }
+
+    m_Persisted = std::move(trains);
+    m_Generation = generation;
+    m_JournalBytes = journalBytes;
+    m_JournaledIds = std::move(touched);
+    if (!journalClean && !m_ReadOnly)
+      CompactLocked(m_Persisted);
+  }
+  EvictBodies();
 }
 
-void TrainManager::SaveTrains() {
+TrainManager::IndexStatus
+TrainManager::LoadIndex(std::vector<TrainTemplate> &trains,
+                        std::map<std::string, LibraryEntry> &index,
+                        uint64_t &generation) {
+  if (!Platform::FileExists(m_IndexPath))
+    return IndexStatus::Missing;
+  Platform::MappedFile file;
+  if (!file.Open(m_IndexPath))
+    return IndexStatus::Unreadable;
+  std::string_view contents = file.View();
+
   json j;
-  j["trains"] = json::array();
+  try {
+    j = json::parse(contents);
+    generation = j.value("generation", 0ull);
+    j.at("trains").get_ref<const json::array_t &>();
+    // Indexes written before the format setting are pretty JSON throughout
+    TrainFormat format = TrainFormat::PrettyJson;
+    TrainCodec::FormatFromName(j.value("format", ""), format);
+    m_IndexFormat = format;
+    m_StorageFormat = format;
+  } catch (...) {
+    // Keep the damaged index for manual recovery; the library is rebuilt
+    // from the shards it named
+    Platform::WriteFileAtomic(m_IndexPath + ".corrupt", std::string(contents));
+    return IndexStatus::Damaged;
+  }
+
+  for (const auto &jEntry : j["trains"]) {
+    LibraryEntry entry;
+    TrainTemplate train;
+    try {
+      entry.Id = jEntry.at("id").get<std::string>();
+      entry.File = jEntry.at("file").get<std::string>();
+      entry.StepCount = jEntry.value("stepCount", size_t(0));
+      entry.Hash = std::stoull(jEntry.at("hash").get<std::string>(), nullptr, 16);
+      entry.MTime = jEntry.value("mtime", 0ll);
+      entry.Format = TrainFormat::PrettyJson;
+      TrainCodec::FormatFromName(jEntry.value("format", ""), entry.Format);
+      TrainSchema::ResetToDefaults(train);
+      TrainCodec::HeaderFromJson(jEntry, train);
+    } catch (...) {
+      m_KeepUnlistedShards = true; // Its shard may be the only copy
+      continue;
+    }
+    train.Id = entry.Id;
+    train.StepsLoaded = false;
+    index[entry.Id] = std::move(entry);
+    trains.push_back(std::move(train));
+  }
+  return IndexStatus::Loaded;
+}
+
+bool TrainManager::RecoverIndex(std::vector<TrainTemplate> &trains,
+                                std::map<std::string, LibraryEntry> &index) {
+  std::vector<std::string> names = Platform::ListDirectory(m_LibraryDir);
+  std::sort(names.begin(), names.end());
+  for (const auto &name : names) {
+    // <id>-<hash>.<ext>; the hash in the name must match the bytes
+    LibraryEntry entry;
+    size_t dash = name.rfind('-');
+    size_t dot = name.rfind('.');
+    if (!ShardFormat(name, entry.Format) || dash == std::string::npos ||
+        dot - dash != 17)
+      continue;
+    std::string hashHex = name.substr(dash + 1, 16);
+    char *end = nullptr;
+    entry.Hash = std::strtoull(hashHex.c_str(), &end, 16);
+    if (*end != '\0')
+      continue;
+
+    Platform::MappedFile file;
+    if (!file.Open(Platform::JoinPath(m_LibraryDir, name)))
+      continue;
+    std::string_view shard = file.View();
+    TrainTemplate train;
+    TrainSchema::ResetToDefaults(train);
+    if (HashBytes(shard) != entry.Hash ||
+        !TrainCodec::Decode(shard, entry.Format, train))
+      continue;
+
+    // Shards left behind by an interrupted compaction repeat an id; every
+    // copy is kept as its own train
+    train.Id = name.substr(0, dash);
+    while (train.Id.empty() || index.count(train.Id))
+      train.Id = NewTrainId();
+    entry.Id = train.Id;
+    entry.File = name;
+    entry.StepCount = train.Steps.size();
+    std::vector<TrainStep>().swap(train.Steps);
+    train.StepsLoaded = false;
+    index[entry.Id] = std::move(entry);
+    trains.push_back(std::move(train));
+  }
+  return !trains.empty();
+}
+
+bool TrainManager::LoadBody(TrainTemplate &train) {
+  TC_PROFILE_SCOPE("TrainManager::LoadBody");
+
+  LibraryEntry entry;
+  {
+    std::lock_guard<std::mutex> lock(m_IndexMutex);
+    auto it = m_Index.find(train.Id);
+    if (it != m_Index.end())
+      entry = it->second;
+  }
+  if (entry.File.empty())
+    return false;
 
-  for (const auto &train : m_Trains) {
-    json jTrain;
-    jTrain["Name"] = train.Name;
-    jTrain["Author"] = train.Author;
-    jTrain["Type"] = static_cast<int>(train.Type);
-
-    jTrain["steps"] = json::array();
-    for (const auto &step : train.Steps) {
-      json jStep;
-      jStep["Title"] = step.Title;
-      jStep["Description"] = step.Description;
-      jStep["WaypointCode"] = step.WaypointCode;
-      jStep["SquadMessage"] = step.SquadMessage;
-      jStep["Mechanics"] = step.Mechanics;
-      jStep["SpawnMinuteUTC"] = step.SpawnMinuteUTC;
-      jStep["DurationMinutes"] = step.DurationMinutes;
-      jStep["CustomMessages"] = json::array();
-      for (const auto &msg : step.CustomMessages) {
-        json jMsg;
-        jMsg["title"] = msg.title;
-        jMsg["text"] = msg.text;
-        jStep["CustomMessages"].push_back(jMsg);
+  std::string shardPath = Platform::JoinPath(m_LibraryDir, entry.File);
+  // Parsed straight from the mapping; only the strings are copied out
+  Platform::MappedFile file;
+  if (!file.Open(shardPath)) {
+    // Present but unreadable (locked, I/O error): leave the train header-only
+    // so no save mistakes it for an empty body and drops the shard
+    if (Platform::FileExists(shardPath))
+      return false;
+  } else {
+    std::string_view shard = file.View();
+    if (HashBytes(shard) == entry.Hash) {
+      TrainTemplate parsed;
+      if (TrainCodec::Decode(shard, entry.Format, parsed)) {
+        train.Steps = std::move(parsed.Steps);
+        train.StepsLoaded = true;
+        return true;
       }
-      jTrain["steps"].push_back(jStep);
     }
-    j["trains"].push_back(jTrain);
+    if (!Platform::WriteFileAtomic(shardPath + ".corrupt", std::string(shard)))
+      return false;
   }
+  // A missing shard, or a damaged one now kept as .corrupt, leaves the train
+  // empty; the next save writes it out as a fresh shard
+  train.Steps.clear();
+  train.StepsLoaded = true;
+  return false;
+}
+
+bool TrainManager::EnsureLoaded(int index) {
+  if (index < 0 || index >= static_cast<int>(m_Trains.size()))
+    return false;
+
+  TrainTemplate &train = m_Trains[index];
+  if (m_Lru.empty() || m_Lru.front() != train.Id) {
+    m_Lru.remove(train.Id);
+    m_Lru.push_front(train.Id);
+  }
+  if (train.StepsLoaded)
+    return true;
+
+  bool loaded = LoadBody(train);
+  if (!train.StepsLoaded)
+    m_Lru.remove(train.Id);
+  EvictBodies();
+  return loaded;
+}
+
+void TrainManager::EvictBodies() {
+  if (m_Lru.size() <= kMaxResidentTrains)
+    return;
+  // Deleted trains leave their ids behind; they must not count
+  std::set<std::string> live;
+  for (const auto &train : m_Trains)
+    live.insert(train.Id);
+  m_Lru.remove_if([&live](const std::string &id) { return !live.count(id); });
+  if (m_Lru.size() <= kMaxResidentTrains)
+    return;
+
+  std::unique_lock<std::mutex> lock(m_WriteMutex, std::try_to_lock);
+  if (!lock.owns_lock())
+    return; // Worker is writing; try again on the next load
+  // A body may only be dropped while its shard is current: every edit is
+  // on disk and none of them went to the journal since the last compaction
+  if (m_WrittenRevision != m_Revision)
+    return;
+
+  const TrainTemplate *active = GetActiveTrain();
+  auto unload = [](std::vector<TrainTemplate> &trains, const std::string &id) {
+    for (auto &train : trains) {
+      if (train.Id == id) {
+        std::vector<TrainStep>().swap(train.Steps);
+        train.StepsLoaded = false;
+      }
+    }
+  };
+
+  auto it = m_Lru.end();
+  while (m_Lru.size() > kMaxResidentTrains && it != m_Lru.begin()) {
+    --it;
+    if ((active && active->Id == *it) || m_JournaledIds.count(*it) ||
+        !m_Index.count(*it))
+      continue;
+    unload(m_Trains, *it);
+    unload(m_Persisted, *it);
+    it = m_Lru.erase(it);
+  }
+}
+
+void TrainManager::MigrateLegacyLibrary() {
+  // Single-file library from earlier versions (trains.json + trains.journal)
+  std::string legacyPath = Platform::JoinPath(m_AddonDir, "trains.json");
+  std::string legacyJournal = Platform::JoinPath(m_AddonDir, "trains.journal");
+
+  Platform::MappedFile file;
+  if (!file.Open(legacyPath))
+    return;
+  std::string_view contents = file.View();
+
+  std::vector<TrainTemplate> trains;
+  uint64_t generation = 0;
+  if (!TrainReader::ReadLibrary(contents, trains, generation)) {
+    Platform::WriteFileAtomic(legacyPath + ".corrupt", std::string(contents));
+    return;
+  }
+
+  bool journalClean = true;
+  std::set<std::string> touched;
+  ReplayJournal(legacyJournal, generation, trains, touched, journalClean,
+                [](TrainTemplate &) {});
+  AssignIds(trains);
+
+  m_Trains = trains;
+  m_QueuedRevision = m_Revision;
+
+  std::lock_guard<std::mutex> lock(m_WriteMutex);
+  m_Persisted.clear();
+  m_JournaledIds.clear();
+  {
+    std::lock_guard<std::mutex> indexLock(m_IndexMutex);
+    m_Index.clear();
+  }
+  m_Lru.clear();
+  for (const auto &train : m_Trains)
+    m_Lru.push_back(train.Id);
+  m_Generation = generation;
+  if (!CompactLocked(trains))
+    return; // Legacy files stay authoritative until a write succeeds
+  m_Persisted = std::move(trains);
+
+  // Keep the old file around once; it is no longer read
+  Platform::WriteFileAtomic(legacyPath + ".migrated", std::string(contents));
+  file.Close(); // Windows refuses to delete a mapped file
+  Platform::RemoveFile(legacyPath);
+  Platform::RemoveFile(legacyJournal);
+}
+
+void TrainManager::AssignIds(std::vector<TrainTemplate> &trains) {
+  std::set<std::string> seen;
+  for (auto &train : trains) {
+    // Copies made in the editor carry their source's id
+    while (train.Id.empty() || !seen.insert(train.Id).second)
+      train.Id = NewTrainId();
+  }
+}
+
+bool TrainManager::SaveTrains() {
+  AssignIds(m_Trains);
+  m_QueuedRevision = m_Revision;
+  // On failure the library stays dirty, so Update retries
+  return WriteLibrary(m_Trains, m_Revision);
+}
+
+void TrainManager::RequestSave() {
+  AssignIds(m_Trains);
+  auto snapshot = std::make_unique<std::vector<TrainTemplate>>(m_Trains);
+  {
+    std::lock_guard<std::mutex> lock(m_SaveMutex);
+    // An unsaved older snapshot is simply replaced
+    m_PendingSnapshot = std::move(snapshot);
+    m_PendingRevision = m_Revision;
+    if (!m_SaveThread.joinable())
+      m_SaveThread = std::thread(&TrainManager::SaveWorker, this);
+  }
+  m_SaveCv.notify_one();
+  m_QueuedRevision = m_Revision;
+  m_RetryDelay = kAutosaveDelay;
+  m_RetryAt = std::chrono::steady_clock::now() + m_RetryDelay;
+}
+
+void TrainManager::MarkDirty() {
+  m_Revision++;
+  m_LastChange = std::chrono::steady_clock::now();
+}
+
+void TrainManager::Update() {
+  if (!IsDirty() || m_ReadOnly)
+    return;
+  auto now = std::chrono::steady_clock::now();
+  if (m_QueuedRevision != m_Revision) {
+    if (now - m_LastChange >= kAutosaveDelay)
+      RequestSave();
+    return;
+  }
+  // Everything is queued but not on disk: still writing, or the write
+  // failed and is retried with a doubling delay
+  if (!m_WriteFailed || now < m_RetryAt)
+    return;
+  auto delay = std::clamp(m_RetryDelay * 2, kAutosaveDelay, kMaxRetryDelay);
+  RequestSave();
+  m_RetryDelay = delay;
+  m_RetryAt = now + m_RetryDelay;
+}
+
+void TrainManager::SaveWorker() {
+  std::unique_lock<std::mutex> lock(m_SaveMutex);
+  for (;;) {
+    m_SaveCv.wait(lock, [this] { return m_StopWorker || m_PendingSnapshot; });
+    if (m_PendingSnapshot) {
+      auto snapshot = std::move(m_PendingSnapshot);
+      uint64_t revision = m_PendingRevision;
+      lock.unlock();
+      WriteLibrary(std::move(*snapshot), revision);
+      lock.lock();
+      continue; // Drain anything queued meanwhile before honouring stop
+    }
+    if (m_StopWorker)
+      return;
+  }
+}
+
+bool TrainManager::WriteLibrary(std::vector<TrainTemplate> trains,
+                                uint64_t revision) {
+  TC_PROFILE_SCOPE("TrainManager::SaveTrains");
+
+  if (m_ReadOnly)
+    return false;
+  std::lock_guard<std::mutex> lock(m_WriteMutex);
+  if (revision < m_WrittenRevision)
+    return true; // A newer snapshot already made it to disk
+
+  std::string records;
+  std::set<std::string> touched;
+  bool written = false;
+  auto loadBody = [this](TrainTemplate &train) { return LoadBody(train); };
+  // A format switch rewrites every shard, so it always compacts
+  if (m_JournalBytes > 0 && m_IndexFormat == m_StorageFormat &&
+      DiffToJournal(m_Persisted, trains, records, touched, loadBody) &&
+      m_JournalBytes + records.size() <= kJournalMaxBytes) {
+    written = records.empty() || Platform::AppendFile(m_JournalPath, records);
+    if (written) {
+      m_JournalBytes += records.size();
+      m_JournaledIds.insert(touched.begin(), touched.end());
+    }
+  }
+  if (!written)
+    written = CompactLocked(trains);
+
+  if (written) {
+    m_Persisted = std::move(trains);
+    m_WrittenRevision = revision;
+  }
+  m_WriteFailed = !written;
+  return written;
+}
+
+bool TrainManager::CompactLocked(const std::vector<TrainTemplate> &trains) {
+  uint64_t generation = m_Generation + 1;
+  TrainFormat format = m_StorageFormat;
 
   // Create dir if missing
-  CreateDirectoryA(m_AddonDir.c_str(), NULL);
+  Platform::EnsureDirectory(m_LibraryDir);
+
+  std::map<std::string, const TrainTemplate *> persisted;
+  for (const auto &train : m_Persisted)
+    persisted[train.Id] = &train;
 
-  std::ofstream file(m_ConfigPath);
-  if (file.is_open()) {
-    file << j.dump(4);
+  // Only trains whose content changed since their shard was written get a
+  // new shard; everything else keeps its index entry
+  std::map<std::string, LibraryEntry> index;
+  json j;
+  j["generation"] = generation;
+  j["format"] = TrainCodec::FormatName(format);
+  j["trains"] = json::array();
+  for (const auto &train : trains) {
+    auto old = m_Index.find(train.Id);
+    auto prev = persisted.find(train.Id);
+    bool current = old != m_Index.end() && old->second.Format == format;
+    LibraryEntry entry;
+    if (!train.StepsLoaded) {
+      // Bodies are only dropped while their shard is current
+      if (old == m_Index.end())
+        return false;
+      if (current) {
+        entry = old->second;
+      } else {
+        // Re-encoding for a new format needs the body back. One that cannot
+        // be read aborts, or its shard would be replaced by an empty one;
+        // a damaged shard is already kept as .corrupt and converts empty.
+        TrainTemplate body = train;
+        if (!LoadBody(body) && !body.StepsLoaded)
+          return false;
+        if (!WriteShard(body, format, entry))
+          return false;
+      }
+    } else if (current && !m_JournaledIds.count(train.Id) &&
+               prev != persisted.end() && prev->second->StepsLoaded &&
+               *prev->second == train) {
+      entry = old->second;
+    } else if (!WriteShard(train, format, entry)) {
+      return false;
+    }
+
+    json jEntry = {{"id", entry.Id}, {"file", entry.File}};
+    TrainCodec::HeaderToJson(train, jEntry);
+    jEntry["stepCount"] = train.Steps.size();
+    jEntry["hash"] = ToHex(entry.Hash);
+    jEntry["mtime"] = entry.MTime;
+    jEntry["format"] = TrainCodec::FormatName(entry.Format);
+    j["trains"].push_back(std::move(jEntry));
+    index[entry.Id] = std::move(entry);
   }
+
+  // The index rename is the commit point: until it lands the old index and
+  // the shards it names are untouched
+  if (!Platform::WriteFileAtomic(m_IndexPath, j.dump(2)))
+    return false;
+  {
+    std::lock_guard<std::mutex> indexLock(m_IndexMutex);
+    m_Index = std::move(index);
+  }
+  m_Generation = generation;
+  m_IndexFormat = format;
+  m_JournaledIds.clear();
+
+  // Start a fresh journal bound to the new base. If this fails the old
+  // journal no longer matches the base generation and is ignored on load.
+  json header = {{"op", "base"}, {"generation", generation}};
+  std::string headerLine = header.dump() + "\n";
+  m_JournalBytes =
+      Platform::WriteFileAtomic(m_JournalPath, headerLine) ? headerLine.size()
+                                                           : 0;
+
+  if (!m_KeepUnlistedShards)
+    RemoveStaleShards();
+  return true;
 }
 
-void TrainManager::SetActiveTrain(int index) {
+bool TrainManager::WriteShard(const TrainTemplate &train, TrainFormat format,
+                              LibraryEntry &entry) {
+  std::string shard = TrainCodec::Encode(train, format);
+  entry.Id = train.Id;
+  entry.StepCount = train.Steps.size();
+  entry.Hash = HashBytes(shard);
+  entry.File = train.Id + "-" + ToHex(entry.Hash) + "." +
+               TrainCodec::FormatExtension(format);
+  entry.MTime = static_cast<int64_t>(std::time(nullptr));
+  entry.Format = format;
+  std::string shardPath = Platform::JoinPath(m_LibraryDir, entry.File);
+  // Same name means same bytes, so an existing shard can be reused
+  return Platform::FileExists(shardPath) ||
+         Platform::WriteFileAtomic(shardPath, shard);
+}
+
+void TrainManager::SetStorageFormat(TrainFormat format) {
+  if (format == m_StorageFormat)
+    return;
+  m_StorageFormat = format;
+  MarkDirty(); // The next save converts the library
+}
+
+void TrainManager::RemoveStaleShards() {
+  std::set<std::string> live;
+  for (const auto &entry : m_Index)
+    live.insert(entry.second.File);
+  for (const auto &name : Platform::ListDirectory(m_LibraryDir)) {
+    // Only shards; .tmp and .corrupt leftovers are kept for inspection
+    TrainFormat format;
+    if (!live.count(name) && ShardFormat(name, format))
+      Platform::RemoveFile(Platform::JoinPath(m_LibraryDir, name));
+  }
+}
+
+bool TrainManager::SetActiveTrain(int index) {
   if (index >= 0 && index < m_Trains.size()) {
+    // Edits to a train without its steps in memory would be lost on save
+    if (!EnsureLoaded(index) && !m_Trains[index].StepsLoaded)
+      return false;
     m_ActiveTrainIndex = index;
     m_CurrentStepIndex = 0;
   } else {
     m_ActiveTrainIndex = -1;
   }
+  return true;
 }
 
 TrainTemplate *TrainManager::GetActiveTrain() {
@@ -123,77 +876,21 @@ void TrainManager::PreviousStep() {
   }
 }
 
-bool TrainManager::ImportFromClipboard(const std::string &base64Json) {
-  std::string decoded = Base64::Decode(base64Json);
-  if (decoded.empty())
+bool TrainManager::ImportFromClipboard(const std::string &shareString,
+                                       std::string *error) {
+  TrainTemplate train;
+  TrainSchema::ResetToDefaults(train);
+  train.Name = "Imported Train";
+  if (!TrainCodec::FromShareString(shareString, train, error))
     return false;
 
-  try {
-    json jTrain = json::parse(decoded);
-    TrainTemplate train;
-    train.Name = jTrain.value("Name", "Imported Train");
-    train.Author = jTrain.value("Author", "Unknown");
-    train.Type = static_cast<TrainType>(jTrain.value("Type", 2));
-
-    for (const auto &jStep : jTrain["steps"]) {
-      TrainStep step;
-      step.Title = jStep.value("Title", "Step");
-      step.Description = jStep.value("Description", "");
-      step.WaypointCode = jStep.value("WaypointCode", "");
-      step.SquadMessage = jStep.value("SquadMessage", "");
-      step.Mechanics = jStep.value("Mechanics", "");
-      step.SpawnMinuteUTC = jStep.value("SpawnMinuteUTC", -1);
-      step.DurationMinutes = jStep.value("DurationMinutes", 0);
-      if (jStep.contains("CustomMessages") && jStep["CustomMessages"].is_array()) {
-        for (const auto &msgObj : jStep["CustomMessages"]) {
-          CustomMessage msg;
-          msg.title = msgObj.value("title", "");
-          msg.text = msgObj.value("text", "");
-          step.CustomMessages.push_back(msg);
-        }
-      }
-      train.Steps.push_back(step);
-    }
-
-    m_Trains.push_back(train);
-    SaveTrains();
-    return true;
-  } catch (...) {
-    return false;
-  }
+  m_Trains.push_back(std::move(train));
+  MarkDirty();
+  return true;
 }
 
 std::string TrainManager::ExportToClipboard(int trainIndex) {
-  if (trainIndex < 0 || trainIndex >= m_Trains.size())
+  if (!EnsureLoaded(trainIndex))
     return "";
-
-  const auto &train = m_Trains[trainIndex];
-  json jTrain;
-  jTrain["Name"] = train.Name;
-  jTrain["Author"] = train.Author;
-  jTrain["Type"] = static_cast<int>(train.Type);
-
-  jTrain["steps"] = json::array();
-  for (const auto &step : train.Steps) {
-    json jStep;
-    jStep["Title"] = step.Title;
-    jStep["Description"] = step.Description;
-    jStep["WaypointCode"] = step.WaypointCode;
-    jStep["SquadMessage"] = step.SquadMessage;
-    jStep["Mechanics"] = step.Mechanics;
-    jStep["SpawnMinuteUTC"] = step.SpawnMinuteUTC;
-    jStep["DurationMinutes"] = step.DurationMinutes;
-    jStep["CustomMessages"] = json::array();
-    for (const auto &msg : step.CustomMessages) {
-      json jMsg;
-      jMsg["title"] = msg.title;
-      jMsg["text"] = msg.text;
-      jStep["CustomMessages"].push_back(jMsg);
-    }
-    jTrain["steps"].push_back(jStep);
-  }
-
-  std::string serialized = jTrain.dump();
-  return Base64::Encode(serialized);
+  return TrainCodec::ToShareString(m_Trains[trainIndex]);
 }
-
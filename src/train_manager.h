@@ -1,39 +1,183 @@
 #pragma once
 
+#include "train_codec.h"
 #include "train_types.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <list>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <set>
 #include <string>
+#include <thread>
 #include <vector>
 
-
 class TrainManager {
 public:
   TrainManager(const std::string &addonDir);
-  ~TrainManager() = default;
+  ~TrainManager();
 
   void LoadTrains();
-  void SaveTrains();
+  // Writes the library synchronously (used on unload and by the editor's
+  // save button); false if it could not be written
+  bool SaveTrains();
+  // Snapshots the library now and writes it on the background worker
+  void RequestSave();
+
+  // Call after every edit to the trains; autosave kicks in once no further
+  // edit arrived for kAutosaveDelay.
+  void MarkDirty();
+  // True until the current revision has reached the disk
+  bool IsDirty() const { return m_Revision != m_WrittenRevision; }
+  // The most recent write, synchronous or autosave, failed; Update retries
+  // with a growing delay
+  bool LastWriteFailed() const { return m_WriteFailed; }
+  // Bumped by MarkDirty; lets views cache data derived from the trains
+  uint64_t GetRevision() const { return m_Revision; }
+  // Per-frame tick driving the debounced autosave and its retries
+  void Update();
+  // True when an existing library could not be read at load. Nothing is
+  // written then, so the files on disk survive for the next session.
+  bool IsReadOnly() const { return m_ReadOnly; }
 
+  // Trains loaded from disk start header-only (StepsLoaded false); call
+  // EnsureLoaded before touching a train's Steps
   std::vector<TrainTemplate> &GetTrains() { return m_Trains; }
+  // Brings the train's steps into memory and marks it most recently used.
+  // Least recently used bodies beyond kMaxResidentTrains are dropped again.
+  bool EnsureLoaded(int index);
 
-  // Directory where addon data (trains.json, etc.) is stored
+  // Directory where addon data (trains/, events cache, etc.) is stored
   const std::string &GetAddonDir() const { return m_AddonDir; }
 
-  void SetActiveTrain(int index);
+  // Loads the train's steps first; a train whose steps cannot be read is
+  // not activated and false is returned. Out of range deactivates.
+  bool SetActiveTrain(int index);
   TrainTemplate *GetActiveTrain();
 
   int GetCurrentStepIndex() const { return m_CurrentStepIndex; }
   void NextStep();
   void PreviousStep();
 
-  bool ImportFromClipboard(const std::string &base64Json);
+  // Encoding of the shard files. Loaded from the index; changing it marks
+  // the library dirty and the next save re-encodes every shard.
+  TrainFormat GetStorageFormat() const { return m_StorageFormat; }
+  void SetStorageFormat(TrainFormat format);
+
+  // `error`, if given, receives the reason an import failed
+  bool ImportFromClipboard(const std::string &shareString,
+                           std::string *error = nullptr);
   std::string ExportToClipboard(int trainIndex);
 
+  static constexpr std::chrono::milliseconds kAutosaveDelay{2000};
+  static constexpr std::chrono::milliseconds kMaxRetryDelay{60000};
+  static constexpr size_t kMaxResidentTrains = 8;
+
 private:
+  // One record of trains/index.json
+  struct LibraryEntry {
+    std::string Id;
+    std::string File; // Shard file name inside the library directory
+    size_t StepCount = 0;
+    uint64_t Hash = 0; // Of the shard bytes
+    int64_t MTime = 0; // When the shard was written (epoch seconds)
+    TrainFormat Format = TrainFormat::PrettyJson;
+  };
+
+  enum class IndexStatus {
+    Missing,    // No index file
+    Unreadable, // The file exists but could not be opened
+    Damaged,    // Opened but not a valid index; kept as index.json.corrupt
+    Loaded,
+  };
+
+  // Reads the index into header-only trains
+  IndexStatus LoadIndex(std::vector<TrainTemplate> &trains,
+                        std::map<std::string, LibraryEntry> &index,
+                        uint64_t &generation);
+  // Rebuilds header-only trains from the shard files when there is no
+  // usable index; every intact shard becomes a train. False if the library
+  // directory holds no shards.
+  bool RecoverIndex(std::vector<TrainTemplate> &trains,
+                    std::map<std::string, LibraryEntry> &index);
+  // Reads a train's shard into its Steps; true only if they were read. A
+  // missing or damaged shard (copied to .corrupt) leaves the train loaded
+  // but empty; one that exists but cannot be opened leaves it untouched.
+  bool LoadBody(TrainTemplate &train);
+  // Drops least recently used bodies whose shard is current
+  void EvictBodies();
+  // Converts a single-file trains.json library into shards
+  void MigrateLegacyLibrary();
+  // Gives every train a unique storage id; render thread only
+  static void AssignIds(std::vector<TrainTemplate> &trains);
+
+  void SaveWorker();
+  // Appends the difference to the last persisted state to the journal, or
+  // compacts into shards when the journal grew too large
+  bool WriteLibrary(std::vector<TrainTemplate> trains, uint64_t revision);
+  // Writes shards for changed trains, commits a new index and restarts the
+  // journal; needs m_WriteMutex held
+  bool CompactLocked(const std::vector<TrainTemplate> &trains);
+  // Encodes `train` into a new shard and fills its index entry
+  bool WriteShard(const TrainTemplate &train, TrainFormat format,
+                  LibraryEntry &entry);
+  // Deletes shards the current index no longer names
+  void RemoveStaleShards();
+
   std::string m_AddonDir;
-  std::string m_ConfigPath;
+  std::string m_LibraryDir;
+  std::string m_IndexPath;
+  std::string m_JournalPath;
   std::vector<TrainTemplate> m_Trains;
 
+  // Ids of trains with resident bodies, most recently used first
+  std::list<std::string> m_Lru;
+
+  // Format for new shards; set on the render thread, read by the worker
+  std::atomic<TrainFormat> m_StorageFormat{TrainFormat::PrettyJson};
+
+  // Set once by LoadTrains, before the worker starts
+  bool m_ReadOnly = false;
+  // The index was rebuilt from shards or skipped damaged records, so shards
+  // it does not name may still hold trains; none are deleted this session
+  bool m_KeepUnlistedShards = false;
+
   int m_ActiveTrainIndex = -1;
   int m_CurrentStepIndex = 0;
+
+  // Autosave state (render thread)
+  uint64_t m_Revision = 0;
+  uint64_t m_QueuedRevision = 0; // Newest revision handed to a write
+  std::chrono::steady_clock::time_point m_LastChange;
+  std::chrono::steady_clock::time_point m_RetryAt;
+  std::chrono::milliseconds m_RetryDelay{0};
+
+  // Background writer; only ever sees snapshots, never m_Trains
+  std::mutex m_SaveMutex;
+  std::condition_variable m_SaveCv;
+  std::unique_ptr<std::vector<TrainTemplate>> m_PendingSnapshot;
+  uint64_t m_PendingRevision = 0;
+  bool m_StopWorker = false;
+  std::thread m_SaveThread;
+
+  // Serializes file writes so an older snapshot never overwrites a newer one
+  std::mutex m_WriteMutex;
+  // Written under m_WriteMutex, read by the render thread
+  std::atomic<uint64_t> m_WrittenRevision{0};
+  std::atomic<bool> m_WriteFailed{false};
+  // On-disk state as of the last write, diffed against to build the journal
+  std::vector<TrainTemplate> m_Persisted;
+  uint64_t m_Generation = 0;  // Index generation the journal extends
+  TrainFormat m_IndexFormat = TrainFormat::PrettyJson; // Of the last index
+  size_t m_JournalBytes = 0;  // 0 = no valid journal, next write compacts
+  // By train id; written under both mutexes, read by the render thread
+  // under m_IndexMutex only
+  std::map<std::string, LibraryEntry> m_Index;
+  std::mutex m_IndexMutex;
+  // Trains with journal records since the last compaction; their shards
+  // are stale even if the train now equals m_Persisted
+  std::set<std::string> m_JournaledIds;
 };
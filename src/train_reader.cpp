@@ -0,0 +1,326 @@
+#include "train_reader.h"
+#include "nlohmann_json.hpp"
+#include "train_schema.h"
+
+#include <cstring>
+#include <iterator>
+
+using json = nlohmann::json;
+
+namespace {
+
+// The legacy single-file library: {"generation": G, "trains": [...]}
+struct LibraryDocument {
+  uint64_t Generation = 0;
+  std::vector<TrainTemplate> Trains;
+};
+
+} // namespace
+
+namespace TrainSchema {
+template <> struct Fields<LibraryDocument> {
+  static constexpr auto Get() {
+    return std::make_tuple(
+        MakeField("generation", &LibraryDocument::Generation, uint64_t(0)),
+        MakeList("trains", &LibraryDocument::Trains));
+  }
+};
+} // namespace TrainSchema
+
+namespace {
+
+class TrainSax;
+
+// Per-type entry points generated from the schema
+struct ObjectOps {
+  // Points the reader at the member named `key`; unknown keys are ignored
+  void (*BindKey)(TrainSax &sax, void *obj, const std::string &key);
+  // Appends a defaulted element to a std::vector of this type
+  void *(*Emplace)(void *list);
+};
+
+template <typename T> const ObjectOps *OpsFor();
+
+// What the value following the current key is stored into
+enum class Slot {
+  Ignore, // Unknown key; value (and any children) skipped
+  String,
+  Number,
+  List, // Anything but an array is ignored, as in the DOM reader
+};
+
+class TrainSax {
+public:
+  template <typename T>
+  explicit TrainSax(T &root) : m_Root(&root), m_RootOps(OpsFor<T>()) {}
+
+  void Bind(std::string &target) {
+    m_Slot = Slot::String;
+    m_String = &target;
+  }
+  template <typename T> void Bind(std::vector<T> &target) {
+    m_Slot = Slot::List;
+    m_List = &target;
+    m_ListOps = OpsFor<T>();
+  }
+  template <typename M> void Bind(M &target) {
+    static_assert(std::is_arithmetic_v<M> || std::is_enum_v<M>,
+                  "schema field of unsupported type");
+    m_Slot = Slot::Number;
+    m_Number = &target;
+    m_SetNumber = [](void *p, int64_t v) {
+      *static_cast<M *>(p) = static_cast<M>(v);
+    };
+  }
+
+  bool null() { return Scalar(Slot::List); }
+  bool boolean(bool val) { return Number(val ? 1 : 0); }
+  bool number_integer(json::number_integer_t val) { return Number(val); }
+  bool number_unsigned(json::number_unsigned_t val) {
+    return Number(static_cast<int64_t>(val));
+  }
+  bool number_float(json::number_float_t val, const json::string_t &) {
+    return Number(static_cast<int64_t>(val));
+  }
+
+  bool string(json::string_t &val) {
+    if (m_Skip)
+      return true;
+    std::string *target = m_Slot == Slot::String ? m_String : nullptr;
+    if (!Scalar(Slot::String))
+      return false;
+    if (target)
+      *target = std::move(val);
+    return true;
+  }
+
+  bool binary(json::binary_t &) { return false; }
+
+  bool start_object(std::size_t) {
+    if (m_Skip)
+      return ++m_Skip, true;
+    if (m_Stack.empty()) {
+      m_Stack.push_back({m_Root, m_RootOps, false});
+      return true;
+    }
+
+    Frame &top = m_Stack.back();
+    if (top.IsList) {
+      void *element = top.Ops->Emplace(top.Obj);
+      m_Stack.push_back({element, top.Ops, false});
+      return true;
+    }
+    return SkipValue();
+  }
+
+  bool key(json::string_t &val) {
+    if (m_Skip)
+      return true;
+    m_Slot = Slot::Ignore;
+    const Frame &top = m_Stack.back();
+    top.Ops->BindKey(*this, top.Obj, val);
+    return true;
+  }
+
+  bool end_object() {
+    if (m_Skip)
+      return --m_Skip, true;
+    m_Stack.pop_back();
+    return true;
+  }
+
+  bool start_array(std::size_t) {
+    if (m_Skip)
+      return ++m_Skip, true;
+    if (m_Stack.empty() || m_Stack.back().IsList)
+      return false; // Arrays only ever appear as object members
+
+    if (m_Slot == Slot::List) {
+      m_Slot = Slot::Ignore;
+      m_Stack.push_back({m_List, m_ListOps, true});
+      return true;
+    }
+    return SkipValue();
+  }
+
+  bool end_array() {
+    if (m_Skip)
+      return --m_Skip, true;
+    m_Stack.pop_back();
+    return true;
+  }
+
+  bool parse_error(std::size_t, const std::string &,
+                   const nlohmann::detail::exception &) {
+    return false;
+  }
+
+private:
+  struct Frame {
+    void *Obj; // The object being filled, or the std::vector of a list
+    const ObjectOps *Ops; // Of the object, or of the list's elements
+    bool IsList;
+  };
+
+  // Accepts a scalar for the current slot if it is `compatible` or ignored.
+  // Scalars are only valid as object members.
+  bool Scalar(Slot compatible) {
+    if (m_Skip)
+      return true;
+    if (m_Stack.empty() || m_Stack.back().IsList)
+      return false;
+    Slot slot = m_Slot;
+    m_Slot = Slot::Ignore;
+    return slot == Slot::Ignore || slot == Slot::List || slot == compatible;
+  }
+
+  bool Number(int64_t val) {
+    if (m_Skip)
+      return true;
+    bool store = m_Slot == Slot::Number;
+    if (!Scalar(Slot::Number))
+      return false;
+    if (store)
+      m_SetNumber(m_Number, val);
+    return true;
+  }
+
+  // An object or array for an unknown key (or a list field holding an
+  // object) is skipped whole; anywhere a scalar was expected it is an error
+  bool SkipValue() {
+    Slot slot = m_Slot;
+    m_Slot = Slot::Ignore;
+    if (slot != Slot::Ignore && slot != Slot::List)
+      return false;
+    m_Skip = 1;
+    return true;
+  }
+
+  void *m_Root;
+  const ObjectOps *m_RootOps;
+  std::vector<Frame> m_Stack;
+
+  Slot m_Slot = Slot::Ignore;
+  std::string *m_String = nullptr;
+  void *m_Number = nullptr;
+  void (*m_SetNumber)(void *, int64_t) = nullptr;
+  void *m_List = nullptr;
+  const ObjectOps *m_ListOps = nullptr;
+  int m_Skip = 0; // Depth inside an ignored container
+};
+
+// Input iterator over a ChunkSource for nlohmann's iterator input adapter.
+// Copies share the source, so only the one the parser advances may be used;
+// a default-constructed iterator is the end.
+class ChunkIterator {
+public:
+  using iterator_category = std::input_iterator_tag;
+  using value_type = char;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const char *;
+  using reference = const char &;
+
+  ChunkIterator() = default;
+  explicit ChunkIterator(const TrainReader::ChunkSource *source)
+      : m_Source(source) {
+    Refill();
+  }
+
+  reference operator*() const { return *m_Pos; }
+  ChunkIterator &operator++() {
+    if (++m_Pos == m_End)
+      Refill();
+    return *this;
+  }
+  bool operator==(const ChunkIterator &other) const {
+    return AtEnd() == other.AtEnd();
+  }
+  bool operator!=(const ChunkIterator &other) const {
+    return !(*this == other);
+  }
+
+private:
+  bool AtEnd() const { return m_Pos == m_End; }
+  void Refill() {
+    std::string_view chunk = (*m_Source)();
+    m_Pos = chunk.data();
+    m_End = chunk.data() + chunk.size();
+  }
+
+  const TrainReader::ChunkSource *m_Source = nullptr;
+  const char *m_Pos = nullptr;
+  const char *m_End = nullptr;
+};
+
+template <typename T> const ObjectOps *OpsFor() {
+  static const ObjectOps ops = {
+      [](TrainSax &sax, void *obj, const std::string &key) {
+        T &target = *static_cast<T *>(obj);
+        bool bound = false;
+        TrainSchema::ForEachField<T>([&](const auto &field) {
+          if (!bound && key == field.Name) {
+            sax.Bind(target.*field.Ptr);
+            bound = true;
+          }
+        });
+      },
+      [](void *list) -> void * {
+        auto &elements = *static_cast<std::vector<T> *>(list);
+        elements.emplace_back();
+        TrainSchema::ResetToDefaults(elements.back());
+        return &elements.back();
+      }};
+  return &ops;
+}
+
+// A train with only the header fields of `out`, which missing fields keep
+TrainTemplate HeaderOf(const TrainTemplate &out) {
+  TrainTemplate train;
+  train.Id = out.Id;
+  TrainSchema::ForEachHeaderField<TrainTemplate>(
+      [&](const auto &field) { train.*field.Ptr = out.*field.Ptr; });
+  return train;
+}
+
+} // namespace
+
+bool TrainReader::ReadTrain(std::string_view text, TrainTemplate &out) {
+  return ReadTrain(text, out, TrainFormat::CompactJson);
+}
+
+bool TrainReader::ReadTrain(std::string_view data, TrainTemplate &out,
+                            TrainFormat format) {
+  json::input_format_t input = json::input_format_t::json;
+  if (format == TrainFormat::Cbor)
+    input = json::input_format_t::cbor;
+  else if (format == TrainFormat::MsgPack)
+    input = json::input_format_t::msgpack;
+
+  TrainTemplate train = HeaderOf(out);
+  TrainSax sax(train);
+  if (!json::sax_parse(data, &sax, input))
+    return false;
+  out = std::move(train);
+  return true;
+}
+
+bool TrainReader::ReadTrain(const ChunkSource &next, TrainTemplate &out) {
+  TrainTemplate train = HeaderOf(out);
+  TrainSax sax(train);
+  if (!json::sax_parse(ChunkIterator(&next), ChunkIterator(), &sax))
+    return false;
+  out = std::move(train);
+  return true;
+}
+
+bool TrainReader::ReadLibrary(std::string_view text,
+                              std::vector<TrainTemplate> &out,
+                              uint64_t &generation) {
+  LibraryDocument library;
+  TrainSax sax(library);
+  if (!json::sax_parse(text, &sax))
+    return false;
+  out = std::move(library.Trains);
+  generation = library.Generation;
+  return true;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include "train_codec.h"
+#include "train_types.h"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Fills the train structs straight from JSON text via nlohmann's SAX
+// interface, without building a DOM first; strings are moved into place.
+// Input is a view, so a memory-mapped file is parsed where it lies.
+// Fields missing from the input keep the value `out` already holds, steps
+// and messages get the same defaults as the DOM readers. Returns false on
+// malformed input or a field of the wrong type.
+class TrainReader {
+public:
+  // One train: {"Name", "Author", "Type", "steps": [...]}
+  static bool ReadTrain(std::string_view text, TrainTemplate &out);
+  // Same document in any storage format (CBOR/MessagePack are read through
+  // the same SAX handler)
+  static bool ReadTrain(std::string_view data, TrainTemplate &out,
+                        TrainFormat format);
+  // JSON pulled a chunk at a time, so a decoder can feed the parser without
+  // producing the whole text first. `next` returns an empty view only once
+  // the input is exhausted; each view stays valid until the next call.
+  using ChunkSource = std::function<std::string_view()>;
+  static bool ReadTrain(const ChunkSource &next, TrainTemplate &out);
+  // Single-file library: {"generation": G, "trains": [...]}
+  static bool ReadLibrary(std::string_view text,
+                          std::vector<TrainTemplate> &out,
+                          uint64_t &generation);
+};
@@ -0,0 +1,107 @@
+#pragma once
+#include "train_types.h"
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+// Compile-time field descriptors for the train model. Every serializer
+// (TrainCodec, TrainReader) walks these tables instead of naming fields
+// itself, so a field is added or renamed in exactly one place. Fields not
+// listed here (TrainTemplate::Id, StepsLoaded) are never serialized.
+namespace TrainSchema {
+
+// `Default` is what readers assign before a field is read; a list field has
+// no default (std::nullptr_t) and starts empty.
+template <typename Owner, typename Member, typename Default> struct Field {
+  const char *Name;
+  Member Owner::*Ptr;
+  Default Value;
+};
+
+template <typename Owner, typename Member, typename Default>
+constexpr Field<Owner, Member, Default> MakeField(const char *name,
+                                                  Member Owner::*ptr,
+                                                  Default value) {
+  return {name, ptr, value};
+}
+
+template <typename Owner, typename Element>
+constexpr Field<Owner, std::vector<Element>, std::nullptr_t>
+MakeList(const char *name, std::vector<Element> Owner::*ptr) {
+  return {name, ptr, nullptr};
+}
+
+template <typename T> struct Fields;
+
+template <> struct Fields<CustomMessage> {
+  static constexpr auto Get() {
+    return std::make_tuple(MakeField("title", &CustomMessage::title, ""),
+                           MakeField("text", &CustomMessage::text, ""));
+  }
+};
+
+template <> struct Fields<Callout> {
+  static constexpr auto Get() {
+    return std::make_tuple(
+        MakeField("Offset", &Callout::OffsetSeconds, -300),
+        MakeField("Content", &Callout::Content,
+                  CalloutContent::WaypointAndMessage),
+        MakeField("CustomMessage", &Callout::CustomMessageIndex, 0));
+  }
+};
+
+template <> struct Fields<TrainStep> {
+  static constexpr auto Get() {
+    return std::make_tuple(
+        MakeField("Title", &TrainStep::Title, "Step"),
+        MakeField("Description", &TrainStep::Description, ""),
+        MakeField("WaypointCode", &TrainStep::WaypointCode, ""),
+        MakeField("SquadMessage", &TrainStep::SquadMessage, ""),
+        MakeField("Mechanics", &TrainStep::Mechanics, ""),
+        MakeField("SpawnMinuteUTC", &TrainStep::SpawnMinuteUTC, -1),
+        MakeField("DurationMinutes", &TrainStep::DurationMinutes, 0),
+        MakeList("CustomMessages", &TrainStep::CustomMessages),
+        MakeList("Callouts", &TrainStep::Callouts));
+  }
+};
+
+template <> struct Fields<TrainTemplate> {
+  static constexpr auto Get() {
+    return std::make_tuple(
+        MakeField("Name", &TrainTemplate::Name, "Unnamed Train"),
+        MakeField("Author", &TrainTemplate::Author, "Unknown"),
+        MakeField("Type", &TrainTemplate::Type, TrainType::Mixed),
+        MakeList("steps", &TrainTemplate::Steps));
+  }
+};
+
+template <typename F> struct IsList : std::false_type {};
+template <typename Owner, typename Element>
+struct IsList<Field<Owner, std::vector<Element>, std::nullptr_t>>
+    : std::true_type {};
+
+// Calls fn(field) for every field of T, in declaration order
+template <typename T, typename Fn> void ForEachField(Fn &&fn) {
+  std::apply([&](const auto &...field) { (fn(field), ...); },
+             Fields<T>::Get());
+}
+
+// Header fields are everything but lists (e.g. a train without its steps)
+template <typename T, typename Fn> void ForEachHeaderField(Fn &&fn) {
+  ForEachField<T>([&](const auto &field) {
+    if constexpr (!IsList<std::decay_t<decltype(field)>>::value)
+      fn(field);
+  });
+}
+
+template <typename T> void ResetToDefaults(T &obj) {
+  ForEachField<T>([&](const auto &field) {
+    using Member = std::decay_t<decltype(obj.*field.Ptr)>;
+    if constexpr (IsList<std::decay_t<decltype(field)>>::value)
+      (obj.*field.Ptr).clear();
+    else
+      obj.*field.Ptr = Member(field.Value);
+  });
+}
+
+} // namespace TrainSchema
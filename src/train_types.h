@@ -10,6 +10,16 @@ struct CustomMessage {
   std::string text;
 };
 
+// What a timed callout sends
+enum class CalloutContent { WaypointAndMessage, Message, Mechanics, CustomMessage };
+
+// Chat line sent automatically at a fixed offset from a step's spawn
+struct Callout {
+  int OffsetSeconds = -300; // Negative = before the spawn
+  CalloutContent Content = CalloutContent::WaypointAndMessage;
+  int CustomMessageIndex = 0; // Into the step's CustomMessages
+};
+
 struct TrainStep {
   std::string Title;
   std::string Description;
@@ -19,11 +29,47 @@ struct TrainStep {
   int SpawnMinuteUTC = -1; // Minute (0-1439), -1 = no schedule
   int DurationMinutes = 0;
   std::vector<CustomMessage> CustomMessages;  // Custom messages for this step
+  std::vector<Callout> Callouts; // Only fire for scheduled steps
 };
 
 struct TrainTemplate {
+  std::string Id; // Storage key of the train's shard, assigned by TrainManager
   std::string Name;
   std::string Author;
   TrainType Type = TrainType::Mixed;
   std::vector<TrainStep> Steps;
+  // False while only the header is resident; see TrainManager::EnsureLoaded
+  bool StepsLoaded = true;
 };
+
+inline bool operator==(const CustomMessage &a, const CustomMessage &b) {
+  return a.title == b.title && a.text == b.text;
+}
+
+inline bool operator==(const Callout &a, const Callout &b) {
+  return a.OffsetSeconds == b.OffsetSeconds && a.Content == b.Content &&
+         a.CustomMessageIndex == b.CustomMessageIndex;
+}
+
+inline bool operator==(const TrainStep &a, const TrainStep &b) {
+  return a.Title == b.Title && a.Description == b.Description &&
+         a.WaypointCode == b.WaypointCode &&
+         a.SquadMessage == b.SquadMessage && a.Mechanics == b.Mechanics &&
+         a.SpawnMinuteUTC == b.SpawnMinuteUTC &&
+         a.DurationMinutes == b.DurationMinutes &&
+         a.CustomMessages == b.CustomMessages && a.Callouts == b.Callouts;
+}
+
+inline bool operator!=(const TrainStep &a, const TrainStep &b) {
+  return !(a == b);
+}
+
+// Content equality; the storage Id is deliberately not compared
+inline bool operator==(const TrainTemplate &a, const TrainTemplate &b) {
+  return a.Name == b.Name && a.Author == b.Author && a.Type == b.Type &&
+         a.Steps == b.Steps;
+}
+
+inline bool operator!=(const TrainTemplate &a, const TrainTemplate &b) {
+  return !(a == b);
+}
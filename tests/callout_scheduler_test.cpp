@@ -0,0 +1,63 @@
+#include "test_util.h"
+
+#include "callout_scheduler.h"
+
+// 2025-09-30 20:00:00 UTC
+static const int64_t kEpochMs = 1759262400000LL;
+
+static FrameClock At(int64_t secondsAfter) {
+  return FrameClock::FromEpochMilliseconds(kEpochMs + secondsAfter * 1000);
+}
+
+static TrainTemplate MakeTrain() {
+  TrainTemplate train;
+  TrainStep step;
+  step.Title = "Tequatl";
+  step.SpawnMinuteUTC = 20 * 60 + 5; // 20:05
+  Callout callout;
+  callout.OffsetSeconds = -60; // 20:04
+  step.Callouts.push_back(callout);
+  train.Steps.push_back(step);
+  return train;
+}
+
+TC_TEST(CalloutScheduler_FiresOnceAtItsOffset) {
+  TrainTemplate train = MakeTrain();
+  CalloutScheduler scheduler;
+  std::vector<CalloutScheduler::Due> due;
+  scheduler.Sync(&train, 1, At(0));
+  scheduler.Update(At(239), due);
+  CHECK(due.empty());
+  scheduler.Update(At(240), due);
+  CHECK(due.size() == 1);
+  scheduler.Update(At(300), due);
+  CHECK(due.size() == 1);
+  CHECK(scheduler.GetPendingCount() == 1); // Filed again for tomorrow
+}
+
+TC_TEST(CalloutScheduler_EditKeepsCalloutDueThisSecond) {
+  TrainTemplate train = MakeTrain();
+  CalloutScheduler scheduler;
+  std::vector<CalloutScheduler::Due> due;
+  scheduler.Sync(&train, 1, At(0));
+  scheduler.Update(At(239), due);
+
+  // An edit lands in the frame the callout comes due, before Update runs
+  train.Steps[0].Title = "Edited";
+  scheduler.Sync(&train, 2, At(240));
+  scheduler.Update(At(240), due);
+  CHECK(due.size() == 1);
+}
+
+TC_TEST(CalloutScheduler_NewTrainDoesNotReplayThePast) {
+  TrainTemplate first = MakeTrain();
+  TrainTemplate second = MakeTrain();
+  CalloutScheduler scheduler;
+  std::vector<CalloutScheduler::Due> due;
+  scheduler.Sync(&first, 1, At(0));
+  scheduler.Update(At(0), due);
+
+  scheduler.Sync(&second, 1, At(250));
+  scheduler.Update(At(250), due);
+  CHECK(due.empty());
+}
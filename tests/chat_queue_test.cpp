@@ -0,0 +1,138 @@
+#include "test_util.h"
+
+#include "chat_queue.h"
+#include <windows.h>
+
+#include <string>
+#include <vector>
+
+using namespace std::chrono_literals;
+using Clock = ChatQueue::Clock;
+
+// The fake game: characters land in the chat input, a submit moves the
+// line to s_Sent
+static std::wstring s_Input;
+static std::vector<std::wstring> s_Sent;
+static std::vector<Clock::time_point> s_SentAt;
+static Clock::time_point s_Now;
+
+static void Submit() {
+  s_Sent.push_back(s_Input);
+  s_SentAt.push_back(s_Now);
+  s_Input.clear();
+}
+
+static void FakeBindAsync(EGameBinds bind, int32_t) {
+  if (bind == GB_UiSquadBroadcastChatCommand)
+    Submit();
+}
+
+static LRESULT FakeSendToGame(HWND, UINT msg, WPARAM wParam, LPARAM) {
+  if (msg == WM_CHAR)
+    s_Input += static_cast<wchar_t>(wParam);
+  else if (msg == WM_KEYDOWN && wParam == VK_RETURN)
+    Submit();
+  return 0;
+}
+
+static AddonAPI_t MakeFakeApi() {
+  s_Input.clear();
+  s_Sent.clear();
+  s_SentAt.clear();
+  s_Now = Clock::time_point() + 1h;
+  AddonAPI_t api = {};
+  api.GameBinds_InvokeAsync = FakeBindAsync;
+  api.WndProc_SendToGameOnly = FakeSendToGame;
+  return api;
+}
+
+// Runs frames of 16ms until the queue is idle or `limit` passed
+static void Drain(ChatQueue &chat, Clock::duration limit = 1min) {
+  Clock::time_point end = s_Now + limit;
+  do {
+    chat.Update(s_Now);
+    s_Now += 16ms;
+  } while (chat.IsBusy() && s_Now < end);
+}
+
+TC_TEST(ChatQueue_MergesQueuedLinesOnOneChannel) {
+  AddonAPI_t api = MakeFakeApi();
+  ChatQueue chat(&api);
+  CHECK(chat.Post("first", true, s_Now));
+  CHECK(chat.Post("second", true, s_Now));
+  CHECK(chat.Post("local", false, s_Now));
+  CHECK(chat.GetPendingCount() == 2);
+  Drain(chat);
+  CHECK((s_Sent == std::vector<std::wstring>{L"/s first | second", L"local"}));
+}
+
+TC_TEST(ChatQueue_DoesNotMergeIntoStartedOrFullMessage) {
+  AddonAPI_t api = MakeFakeApi();
+  ChatQueue chat(&api);
+  CHECK(chat.Post("typing", true, s_Now));
+  chat.Update(s_Now); // Focuses the input for it
+  CHECK(chat.Post("next", true, s_Now));
+  CHECK(chat.GetPendingCount() == 2);
+
+  std::string longText(ChatQueue::MaxTextLength(true) - 2, 'x');
+  CHECK(chat.Post(longText, true, s_Now));
+  CHECK(chat.GetPendingCount() == 3);
+  Drain(chat);
+  CHECK(s_Sent.size() == 3);
+  CHECK(s_Sent[0] == L"/s typing");
+  CHECK(s_Sent[1] == L"/s next");
+  CHECK(s_Sent[2].size() == ChatQueue::kMaxLineLength - 2);
+}
+
+TC_TEST(ChatQueue_DropsOnlyQuickRepeatsOfOneLinePosts) {
+  AddonAPI_t api = MakeFakeApi();
+  ChatQueue chat(&api);
+  CHECK(chat.Post("stack", true, s_Now));
+  CHECK(chat.Post("stack", true, s_Now + 100ms)); // Double click
+  CHECK(chat.Post("stack", false, s_Now + 150ms)); // Other channel
+  CHECK(chat.Post("stack", true, s_Now + ChatQueue::kRepeatWindow));
+  Drain(chat);
+  CHECK((s_Sent == std::vector<std::wstring>{L"/s stack", L"stack",
+                                             L"/s stack"}));
+
+  // Repeating the last merged text on purpose still queues it
+  s_Sent.clear();
+  CHECK(chat.Post("go", true, s_Now));
+  CHECK(chat.Post("left", true, s_Now));
+  CHECK(chat.Post("left", true, s_Now + ChatQueue::kRepeatWindow));
+  Drain(chat);
+  CHECK((s_Sent == std::vector<std::wstring>{L"/s go | left | left"}));
+
+  // Multi-line posts always go out whole
+  s_Sent.clear();
+  std::string longText(ChatQueue::MaxTextLength(true) + 10, 'y');
+  CHECK(chat.Post(longText, true, s_Now));
+  CHECK(chat.Post(longText, true, s_Now));
+  CHECK(chat.GetPendingCount() == 4);
+  Drain(chat);
+  CHECK(s_Sent.size() == 4);
+}
+
+TC_TEST(ChatQueue_PacesSubmitsAndEstimatesDrain) {
+  AddonAPI_t api = MakeFakeApi();
+  ChatQueue chat(&api);
+  // Lines too long to merge, sent back to back
+  std::string line(120, 'z');
+  for (int i = 0; i < 6; ++i) {
+    line[0] = static_cast<char>('a' + i);
+    CHECK(chat.Post(line, true, s_Now));
+  }
+  CHECK(chat.GetPendingCount() == 6);
+  Clock::time_point posted = s_Now;
+  Clock::duration estimate = chat.EstimateDrainTime(s_Now);
+  Drain(chat);
+  CHECK(s_Sent.size() == 6);
+  for (size_t i = 1; i < s_SentAt.size(); ++i)
+    CHECK(s_SentAt[i] - s_SentAt[i - 1] >= ChatQueue::kMinSpacing);
+  // Past the burst, starts follow the refill rate
+  for (size_t i = ChatQueue::kBurst; i < s_SentAt.size(); ++i)
+    CHECK(s_SentAt[i] - s_SentAt[i - ChatQueue::kBurst] >=
+          ChatQueue::kRefillInterval);
+  Clock::duration actual = s_SentAt.back() - posted;
+  CHECK(estimate > actual - 100ms && estimate < actual + 100ms);
+}
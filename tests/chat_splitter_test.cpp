@@ -0,0 +1,107 @@
+#include "test_util.h"
+
+#include "chat_splitter.h"
+
+#include <string>
+#include <vector>
+
+static std::vector<std::string> Split(std::string_view text, size_t maxLength) {
+  std::vector<std::string_view> pieces;
+  ChatSplitter::Split(text, maxLength, pieces);
+  return std::vector<std::string>(pieces.begin(), pieces.end());
+}
+
+using Lines = std::vector<std::string>;
+
+// U+00E9, U+20AC and U+1F600: 2, 3 and 4 bytes; the last is a surrogate
+// pair, so two units
+#define E_ACUTE "\xC3\xA9"
+#define EURO "\xE2\x82\xAC"
+#define GRIN "\xF0\x9F\x98\x80"
+
+TC_TEST(ChatSplitter_BreaksAtWhitespace) {
+  CHECK((Split("aaa bbb ccc", 7) == Lines{"aaa bbb", "ccc"}));
+  CHECK((Split("aaa bbb ccc", 11) == Lines{"aaa bbb ccc"}));
+  // Whitespace between words on one line stays as typed
+  CHECK((Split("  aaa  bbb  ", 20) == Lines{"aaa  bbb"}));
+
+  std::string text = "one two three";
+  std::vector<std::string_view> pieces;
+  ChatSplitter::Split(text, 5, pieces);
+  CHECK(pieces.size() == 3);
+  for (auto piece : pieces)
+    CHECK(piece.data() >= text.data() &&
+          piece.data() + piece.size() <= text.data() + text.size());
+}
+
+TC_TEST(ChatSplitter_CountsUtf16Units) {
+  CHECK(ChatSplitter::Length(E_ACUTE) == 1);
+  CHECK(ChatSplitter::Length(EURO) == 1);
+  CHECK(ChatSplitter::Length(GRIN) == 2);
+  CHECK(ChatSplitter::Length("a" E_ACUTE EURO GRIN) == 5);
+}
+
+TC_TEST(ChatSplitter_TwoByteSequenceAtLimit) {
+  CHECK((Split("abcd" E_ACUTE, 5) == Lines{"abcd" E_ACUTE}));
+  CHECK((Split("abcd" E_ACUTE E_ACUTE, 5) == Lines{"abcd" E_ACUTE, E_ACUTE}));
+  CHECK((Split("abc " E_ACUTE E_ACUTE, 5) == Lines{"abc", E_ACUTE E_ACUTE}));
+}
+
+TC_TEST(ChatSplitter_ThreeByteSequenceAtLimit) {
+  CHECK((Split("abcd" EURO, 5) == Lines{"abcd" EURO}));
+  CHECK((Split("abcd" EURO EURO, 5) == Lines{"abcd" EURO, EURO}));
+}
+
+TC_TEST(ChatSplitter_FourByteSequenceAtLimit) {
+  CHECK((Split("abc" GRIN, 5) == Lines{"abc" GRIN}));
+  // One unit left on the line is not enough for a surrogate pair
+  CHECK((Split("abcd" GRIN, 5) == Lines{"abcd", GRIN}));
+  CHECK((Split(GRIN GRIN GRIN, 5) == Lines{GRIN GRIN, GRIN}));
+}
+
+TC_TEST(ChatSplitter_StrayContinuationBytes) {
+  // Each stray or truncated byte is one character of its own
+  CHECK(ChatSplitter::Length("\x80\x80" "abc") == 5);
+  CHECK(ChatSplitter::Length("ab\xE2\x82") == 4);
+  CHECK((Split("\x80\x80" "abc", 3) == Lines{"\x80\x80" "a", "bc"}));
+  CHECK((Split("ab\xE2\x82", 3) == Lines{"ab\xE2", "\x82"}));
+  CHECK((Split("\xF0\x9F x", 10) == Lines{"\xF0\x9F x"}));
+}
+
+TC_TEST(ChatSplitter_LinkAtLimit) {
+  const std::string link = "[&BAAAAAA=]"; // 11 units
+  CHECK((Split("go " + link, 14) == Lines{"go " + link}));
+  CHECK((Split("go " + link, 13) == Lines{"go", link}));
+  CHECK((Split(link, 11) == Lines{link}));
+  // A link glued to a word still moves to the next line whole
+  CHECK((Split("wp:" + link, 11) == Lines{"wp:", link}));
+  CHECK((Split("wp:" + link, 14) == Lines{"wp:" + link}));
+}
+
+TC_TEST(ChatSplitter_LinkOverLimit) {
+  // Only a link longer than a whole line is cut, into full lines
+  CHECK((Split("hi [&BAAAAAA=]", 8) == Lines{"hi", "[&BAAAAA", "A=]"}));
+  // An unterminated link is an ordinary word
+  CHECK((Split("[&BAAA AAA", 6) == Lines{"[&BAAA", "AAA"}));
+}
+
+TC_TEST(ChatSplitter_OversizedWord) {
+  CHECK((Split("aaaaaaaaaa", 4) == Lines{"aaaa", "aaaa", "aa"}));
+  // The tail of a cut word stays open for what follows
+  CHECK((Split("aaaaaaaaaa b", 4) == Lines{"aaaa", "aaaa", "aa b"}));
+  CHECK((Split("x aaaaaaaaaa", 4) == Lines{"x", "aaaa", "aaaa", "aa"}));
+  CHECK((Split(std::string(3, 'a'), 1) == Lines{"a", "a", "a"}));
+}
+
+TC_TEST(ChatSplitter_NewlineStartsNewLine) {
+  CHECK((Split("a\nb", 100) == Lines{"a", "b"}));
+  CHECK((Split("a \n\n  b\n", 100) == Lines{"a", "b"}));
+  CHECK((Split("a\r\nb", 100) == Lines{"a", "b"}));
+  CHECK((Split("aaa bbb\nc", 5) == Lines{"aaa", "bbb", "c"}));
+}
+
+TC_TEST(ChatSplitter_WhitespaceOnlyInput) {
+  CHECK(Split("", 10).empty());
+  CHECK(Split("   \t\r\n  \n", 10).empty());
+  CHECK(Split("text", 0).empty());
+}
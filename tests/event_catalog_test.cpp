@@ -0,0 +1,75 @@
+#include "test_util.h"
+
+#include "event_catalog.h"
+
+// 2025-09-30 23:50:00 UTC, ten minutes before the day wraps
+static const int64_t kLateEveningMs = 1759276200000LL;
+
+static EventDefinition MakeEvent(const char *name, std::vector<int> spawns) {
+  EventDefinition ev;
+  ev.Name = name;
+  ev.Map = "Test";
+  ev.WaypointCode = "[&BAAAAAA=]";
+  ev.SpawnTimesUTC = spawns;
+  ev.DurationsUTC.assign(spawns.size(), 15);
+  return ev;
+}
+
+static void Populate(EventCatalog &catalog) {
+  catalog.SetEvents({MakeEvent("Shatterer", {60, 1425}),
+                     MakeEvent("Tequatl", {5}),
+                     MakeEvent("Jormag", {1435}),
+                     MakeEvent("Shatterer", {720})});
+}
+
+TC_TEST(EventCatalog_SetEventsBumpsRevision) {
+  EventCatalog catalog(TestUtil::FreshDirectory("event_catalog"));
+  uint64_t before = catalog.GetRevision();
+  catalog.SetEvents({MakeEvent("Tequatl", {5})});
+  CHECK(catalog.GetRevision() == before + 1);
+}
+
+TC_TEST(EventCatalog_UpcomingEventsWrapPastMidnight) {
+  EventCatalog catalog(TestUtil::FreshDirectory("event_catalog"));
+  Populate(catalog);
+  FrameClock clock = FrameClock::FromEpochMilliseconds(kLateEveningMs);
+  auto upcoming = catalog.GetUpcomingEvents(clock);
+  CHECK(upcoming.size() == 4);
+  if (upcoming.size() != 4)
+    return;
+  // Sorted by start; events up to 15 minutes old still count as upcoming
+  CHECK(upcoming[0].Definition.Name == "Shatterer");
+  CHECK(upcoming[0].MinutesUntilSpawn == -5);
+  CHECK(upcoming[1].Definition.Name == "Jormag");
+  CHECK(upcoming[1].MinutesUntilSpawn == 5);
+  CHECK(upcoming[2].Definition.Name == "Tequatl");
+  CHECK(upcoming[2].MinutesUntilSpawn == 15);
+  CHECK(upcoming[3].MinutesUntilSpawn == 730);
+
+  CHECK(catalog.GetUpcomingEvents(clock, 2).size() == 2);
+}
+
+TC_TEST(EventCatalog_EventsInRange) {
+  EventCatalog catalog(TestUtil::FreshDirectory("event_catalog"));
+  Populate(catalog);
+  FrameClock clock = FrameClock::FromEpochMilliseconds(kLateEveningMs);
+  auto inRange = catalog.GetEventsInRange(clock, -10, 70);
+  CHECK(inRange.size() == 4);
+  if (inRange.size() != 4)
+    return;
+  CHECK(inRange[0].MinutesUntilSpawn == -5);
+  CHECK(inRange[1].MinutesUntilSpawn == 5);
+  CHECK(inRange[2].MinutesUntilSpawn == 15);
+  CHECK(inRange[3].MinutesUntilSpawn == 70);
+  CHECK(inRange[3].ExactMinutesUntilSpawn == 70.0f);
+
+  CHECK(catalog.GetEventsInRange(clock, 20, 60).empty());
+}
+
+TC_TEST(EventCatalog_SpawnMinutesMergeSameName) {
+  EventCatalog catalog(TestUtil::FreshDirectory("event_catalog"));
+  Populate(catalog);
+  auto minutes = catalog.GetSpawnMinutes("Shatterer");
+  CHECK((minutes == std::vector<int>{60, 1425, 720}));
+  CHECK(catalog.GetSpawnMinutes("Nobody").empty());
+}
@@ -0,0 +1,58 @@
+#include "test_util.h"
+
+#include "frame_clock.h"
+
+// 2025-09-30 20:00:00 UTC
+static const int64_t kEpochMs = 1759262400000LL;
+
+TC_TEST(FrameClock_SplitsEpochIntoTimeOfDay) {
+  FrameClock clock = FrameClock::FromEpochMilliseconds(kEpochMs + 61500);
+  CHECK(clock.EpochMilliseconds == kEpochMs + 61500);
+  CHECK(clock.EpochSeconds == kEpochMs / 1000 + 61);
+  CHECK(clock.MinuteOfDay == 20 * 60 + 1);
+  CHECK(clock.Second == 1);
+  CHECK(clock.SecondOfDay() == (20 * 60 + 1) * 60 + 1);
+  CHECK(clock.FractionalMinute > 0.0249f && clock.FractionalMinute < 0.0251f);
+}
+
+TC_TEST(FrameClock_HandlesTimesBeforeEpoch) {
+  FrameClock clock = FrameClock::FromEpochMilliseconds(-1);
+  CHECK(clock.EpochSeconds == -1);
+  CHECK(clock.MinuteOfDay == 1439);
+  CHECK(clock.Second == 59);
+}
+
+TC_TEST(FrameClock_SecondsUntilDailySpawn) {
+  FrameClock clock = FrameClock::FromEpochMilliseconds(kEpochMs);
+  CHECK(clock.SecondsUntilDailySpawn(20 * 60 + 10, 15) == 600);
+  // Started five minutes ago and still running
+  CHECK(clock.SecondsUntilDailySpawn(20 * 60 - 5, 15) == -300);
+  // Over for today, so the next one is tomorrow
+  CHECK(clock.SecondsUntilDailySpawn(20 * 60 - 20, 15) == 86400 - 1200);
+  CHECK(clock.SecondsUntilDailySpawn(20 * 60, 0) == 86400);
+}
+
+TC_TEST(FrameClock_NextDailyOccurrence) {
+  const int64_t day = FrameClock::kSecondsPerDay;
+  const int64_t now = kEpochMs / 1000; // 20:00:00
+  const int64_t eight = 20 * 3600;
+  CHECK(FrameClock::NextDailyOccurrence(eight + 300, now) == now + 300);
+  // Due this very second counts as passed, so tomorrow's is next
+  CHECK(FrameClock::NextDailyOccurrence(eight, now) == now + day);
+  CHECK(FrameClock::NextDailyOccurrence(eight, now - 1) == now);
+  CHECK(FrameClock::NextDailyOccurrence(eight - 1, now) == now + day - 1);
+  // Offsets before midnight or past the end of the day wrap around
+  CHECK(FrameClock::NextDailyOccurrence(-60, now) == now + 4 * 3600 - 60);
+  CHECK(FrameClock::NextDailyOccurrence(day + eight + 60, now) == now + 60);
+  // Times before the epoch
+  CHECK(FrameClock::NextDailyOccurrence(0, -1) == 0);
+  CHECK(FrameClock::NextDailyOccurrence(day - 1, -day) == -1);
+}
+
+TC_TEST(FrameClock_SourceOverridesSystemClock) {
+  FrameClock::SetSource([] { return kEpochMs; });
+  FrameClock clock = FrameClock::Now();
+  FrameClock::SetSource(nullptr);
+  CHECK(clock.EpochMilliseconds == kEpochMs);
+  CHECK(FrameClock::Now().EpochMilliseconds > kEpochMs);
+}
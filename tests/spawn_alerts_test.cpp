@@ -0,0 +1,134 @@
+#include "test_util.h"
+
+#include "platform.h"
+#include "spawn_alerts.h"
+
+#include <string>
+#include <vector>
+
+// 2025-09-30 20:00:00 UTC
+static const int64_t kEpochMs = 1759262400000LL;
+
+static FrameClock At(int64_t secondsAfter) {
+  return FrameClock::FromEpochMilliseconds(kEpochMs + secondsAfter * 1000);
+}
+
+// Alerts for the train's steps, 5 and 1 minutes ahead
+static SpawnAlerts MakeAlerts(const std::string &dir) {
+  SpawnAlerts alerts(dir);
+  SpawnAlerts::Settings settings;
+  settings.TrainSteps = true;
+  settings.LeadMinutes = {5, 1};
+  alerts.SetSettings(settings);
+  return alerts;
+}
+
+static TrainTemplate MakeTrain() {
+  TrainTemplate train;
+  TrainStep step;
+  step.Title = "Tequatl";
+  step.SpawnMinuteUTC = 20 * 60 + 10; // 20:10
+  train.Steps.push_back(step);
+  step.Title = "Unscheduled";
+  step.SpawnMinuteUTC = -1;
+  train.Steps.push_back(step);
+  return train;
+}
+
+using Texts = std::vector<std::string>;
+
+TC_TEST(SpawnAlerts_NormalizesLeadMinutes) {
+  std::string dir = TestUtil::FreshDirectory("spawn_alerts");
+  SpawnAlerts alerts(dir);
+  uint64_t revision = alerts.GetSettingsRevision();
+  SpawnAlerts::Settings settings;
+  settings.LeadMinutes = {1, 5, 5, -3, 1000};
+  alerts.SetSettings(settings);
+  CHECK((alerts.GetSettings().LeadMinutes == std::vector<int>{720, 5, 1, 0}));
+  CHECK(alerts.GetSettingsRevision() == revision + 1);
+
+  // Hand-edited files are normalized the same way
+  CHECK(Platform::WriteFileAtomic(Platform::JoinPath(dir, "alerts.json"),
+                                  R"({"leadMinutes": [2, 15, 2]})"));
+  SpawnAlerts loaded(dir);
+  revision = loaded.GetSettingsRevision();
+  loaded.Load();
+  CHECK((loaded.GetSettings().LeadMinutes == std::vector<int>{15, 2}));
+  CHECK(loaded.GetSettingsRevision() == revision + 1);
+}
+
+TC_TEST(SpawnAlerts_FiresEachLeadAndReschedules) {
+  SpawnAlerts alerts = MakeAlerts(TestUtil::FreshDirectory("spawn_alerts"));
+  TrainTemplate train = MakeTrain();
+  Texts texts;
+  alerts.Sync(&train, 1, nullptr, At(0));
+  CHECK(alerts.GetPendingCount() == 2);
+
+  alerts.Update(At(299), texts);
+  CHECK(texts.empty());
+  alerts.Update(At(300), texts);
+  CHECK((texts == Texts{"Tequatl starts in 5 minutes"}));
+  alerts.Update(At(540), texts);
+  CHECK((texts == Texts{"Tequatl starts in 5 minutes",
+                        "Tequatl starts in 1 minute"}));
+  // Both filed again for tomorrow
+  CHECK(alerts.GetPendingCount() == 2);
+  texts.clear();
+  alerts.Update(At(86400 + 299), texts);
+  CHECK(texts.empty());
+  alerts.Update(At(86400 + 300), texts);
+  CHECK(texts.size() == 1);
+}
+
+TC_TEST(SpawnAlerts_DropsLateAlertsButKeepsThem) {
+  SpawnAlerts alerts = MakeAlerts(TestUtil::FreshDirectory("spawn_alerts"));
+  TrainTemplate train = MakeTrain();
+  Texts texts;
+  alerts.Sync(&train, 1, nullptr, At(0));
+  alerts.Update(At(0), texts);
+  // A loading screen swallowed both deadlines
+  alerts.Update(At(600), texts);
+  CHECK(texts.empty());
+  CHECK(alerts.GetPendingCount() == 2);
+  alerts.Update(At(86400 + 300), texts);
+  CHECK(texts.size() == 1);
+}
+
+TC_TEST(SpawnAlerts_EditKeepsAlertDueThisSecond) {
+  SpawnAlerts alerts = MakeAlerts(TestUtil::FreshDirectory("spawn_alerts"));
+  TrainTemplate train = MakeTrain();
+  Texts texts;
+  alerts.Sync(&train, 1, nullptr, At(0));
+  alerts.Update(At(299), texts);
+
+  // An edit lands in the frame the alert comes due, before Update runs
+  train.Steps[0].Title = "Edited";
+  alerts.Sync(&train, 2, nullptr, At(300));
+  alerts.Update(At(300), texts);
+  CHECK((texts == Texts{"Edited starts in 5 minutes"}));
+}
+
+TC_TEST(SpawnAlerts_PinnedCatalogEvents) {
+  std::string dir = TestUtil::FreshDirectory("spawn_alerts");
+  EventCatalog catalog(dir);
+  EventDefinition ev;
+  ev.Name = "Jormag";
+  ev.SpawnTimesUTC = {20 * 60 + 2, 22 * 60};
+  ev.DurationsUTC = {15, 15};
+  catalog.SetEvents({ev});
+
+  SpawnAlerts alerts(dir);
+  SpawnAlerts::Settings settings;
+  settings.LeadMinutes = {0};
+  alerts.SetSettings(settings);
+  Texts texts;
+  alerts.Sync(nullptr, 0, &catalog, At(0));
+  CHECK(alerts.GetPendingCount() == 0);
+
+  alerts.TogglePin("Jormag");
+  CHECK(alerts.IsPinned("Jormag"));
+  alerts.Sync(nullptr, 0, &catalog, At(0));
+  CHECK(alerts.GetPendingCount() == 2);
+  alerts.Update(At(120), texts);
+  CHECK((texts == Texts{"Jormag is starting now"}));
+}
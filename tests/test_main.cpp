@@ -0,0 +1,61 @@
+// Runs every registered test, or those whose name contains the filter.
+//
+//   tc_tests [filter]
+
+#include "test_util.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <vector>
+
+namespace {
+
+struct TestCase {
+  const char *Name;
+  TestUtil::TestFn Fn;
+};
+
+std::vector<TestCase> &Registry() {
+  static std::vector<TestCase> tests;
+  return tests;
+}
+
+int s_Failures = 0;
+
+} // namespace
+
+TestUtil::Registrar::Registrar(const char *name, TestFn fn) {
+  Registry().push_back({name, fn});
+}
+
+void TestUtil::Fail(const char *file, int line, const char *expr) {
+  printf("  %s:%d: CHECK(%s) failed\n", file, line, expr);
+  s_Failures++;
+}
+
+std::string TestUtil::FreshDirectory(const std::string &name) {
+  namespace fs = std::filesystem;
+  fs::path dir = fs::temp_directory_path() / ("tc_tests_" + name);
+  fs::remove_all(dir);
+  fs::create_directories(dir);
+  return dir.string();
+}
+
+int main(int argc, char **argv) {
+  const char *filter = argc > 1 ? argv[1] : "";
+  int run = 0, failed = 0;
+  for (const TestCase &test : Registry()) {
+    if (!strstr(test.Name, filter))
+      continue;
+    int failuresBefore = s_Failures;
+    test.Fn();
+    run++;
+    bool ok = s_Failures == failuresBefore;
+    if (!ok)
+      failed++;
+    printf("%-4s %s\n", ok ? "ok" : "FAIL", test.Name);
+  }
+  printf("%d tests, %d failed\n", run, failed);
+  return failed == 0 && run > 0 ? 0 : 1;
+}
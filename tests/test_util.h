@@ -0,0 +1,33 @@
+#pragma once
+
+#include <string>
+
+// Minimal self-registering test harness for the core library; no external
+// framework so the tests build wherever tc_core does.
+namespace TestUtil {
+
+using TestFn = void (*)();
+
+struct Registrar {
+  Registrar(const char *name, TestFn fn);
+};
+
+// Records a failed check; the test keeps running so one run reports every
+// broken expectation
+void Fail(const char *file, int line, const char *expr);
+
+// Empty directory under the system temp dir, unique to this test name
+std::string FreshDirectory(const std::string &name);
+
+} // namespace TestUtil
+
+#define TC_TEST(name)                                                          \
+  static void name();                                                          \
+  static TestUtil::Registrar name##_registrar(#name, name);                    \
+  static void name()
+
+#define CHECK(expr)                                                            \
+  do {                                                                         \
+    if (!(expr))                                                               \
+      TestUtil::Fail(__FILE__, __LINE__, #expr);                               \
+  } while (0)
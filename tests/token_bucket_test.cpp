@@ -0,0 +1,41 @@
+#include "test_util.h"
+
+#include "token_bucket.h"
+
+using namespace std::chrono_literals;
+
+static const TokenBucket::Clock::time_point kStart =
+    TokenBucket::Clock::time_point() + 1h;
+
+TC_TEST(TokenBucket_BurstThenRefillRate) {
+  TokenBucket bucket(3, 3s);
+  CHECK(bucket.GetAvailable(kStart) == 3);
+  CHECK(bucket.TryTake(kStart));
+  CHECK(bucket.TryTake(kStart + 100ms));
+  CHECK(bucket.TryTake(kStart + 200ms));
+  CHECK(!bucket.TryTake(kStart + 300ms));
+  // The refill counts from the first take out of a full bucket
+  CHECK(bucket.NextAvailable(kStart + 300ms) == kStart + 3s);
+  CHECK(!bucket.TryTake(kStart + 3s - 1ms));
+  CHECK(bucket.TryTake(kStart + 3s));
+  CHECK(bucket.NextAvailable(kStart + 4s) == kStart + 6s);
+}
+
+TC_TEST(TokenBucket_KeepsPartialIntervals) {
+  TokenBucket bucket(2, 3s);
+  CHECK(bucket.TryTake(kStart));
+  CHECK(bucket.TryTake(kStart));
+  // One token at +3s; the half interval after it still counts toward +6s
+  CHECK(bucket.GetAvailable(kStart + 4500ms) == 1);
+  CHECK(bucket.TryTake(kStart + 4500ms));
+  CHECK(bucket.NextAvailable(kStart + 4500ms) == kStart + 6s);
+  // Idle long enough refills to capacity and no further
+  CHECK(bucket.GetAvailable(kStart + 1min) == 2);
+}
+
+TC_TEST(TokenBucket_CapacityIsAtLeastOne) {
+  TokenBucket bucket(0, 1s);
+  CHECK(bucket.TryTake(kStart));
+  CHECK(!bucket.TryTake(kStart));
+  CHECK(bucket.TryTake(kStart + 1s));
+}
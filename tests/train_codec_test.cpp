@@ -0,0 +1,156 @@
+#include "test_util.h"
+
+#include "base64.h"
+#include "train_codec.h"
+#include "train_schema.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+
+// A plain train, one with little repetition between steps, and values no
+// generator produces
+static std::vector<TrainTemplate> Samples() {
+  std::vector<TrainTemplate> trains(5);
+  for (auto &train : trains)
+    TrainSchema::ResetToDefaults(train);
+
+  trains[0].Name = "Tequatl";
+  trains[0].Author = "Commander";
+  for (int s = 0; s < 4; ++s) {
+    TrainStep step;
+    TrainSchema::ResetToDefaults(step);
+    step.Title = "Step " + std::to_string(s);
+    step.WaypointCode = "[&BNABAAA=]";
+    step.SquadMessage = "Next up: {title} {wp} ({eta})";
+    step.Mechanics = "Group 1 left\nGroup 2 right";
+    step.SpawnMinuteUTC = s * 15;
+    step.DurationMinutes = 15;
+    step.CustomMessages.push_back({"Ready", "Stack on the tag"});
+    trains[0].Steps.push_back(step);
+  }
+
+  static const char *kWords[] = {"pull",  "left",   "right", "stack", "dodge",
+                                 "break", "cleave", "kite",  "portal", "wall",
+                                 "tag",   "adds",   "phase", "ooze",   "burn"};
+  uint32_t seed = 12345;
+  auto next = [&] { return seed = seed * 1664525u + 1013904223u; };
+  auto sentence = [&](int words) {
+    std::string text;
+    for (int w = 0; w < words; ++w)
+      text += std::string(w ? " " : "") + kWords[(next() >> 8) % 15] +
+              std::to_string(next() % 100);
+    return text;
+  };
+  trains[1].Name = "Varied Train";
+  for (int s = 0; s < 20; ++s) {
+    TrainStep step;
+    TrainSchema::ResetToDefaults(step);
+    step.Title = sentence(3);
+    step.Description = sentence(12);
+    step.Mechanics = sentence(40);
+    step.SpawnMinuteUTC = static_cast<int>(next() % 1440);
+    step.DurationMinutes = static_cast<int>(next() % 30);
+    step.CustomMessages.push_back({sentence(2), sentence(15)});
+    trains[1].Steps.push_back(step);
+  }
+
+  trains[2].Name = ""; // Empty strings and no steps
+  trains[2].Author = "";
+  trains[2].Type = TrainType::Boss;
+
+  trains[3].Name = "Drachenstein \xe2\x80\x94 \"quoted\" \\ \n\t\x01";
+  TrainStep step;
+  TrainSchema::ResetToDefaults(step);
+  step.SpawnMinuteUTC = 1439;
+  step.DurationMinutes = -5;
+  step.CustomMessages.push_back({"", ""});
+  step.CustomMessages.push_back({"[&BDAEAAA=]", std::string(3000, 'x')});
+  step.Callouts.push_back({-300, CalloutContent::WaypointAndMessage, 0});
+  step.Callouts.push_back({30, CalloutContent::CustomMessage, 1});
+  trains[3].Steps.push_back(step);
+  trains[3].Steps.push_back(TrainStep()); // Struct defaults, not schema ones
+
+  trains[4].Type = TrainType::Farm;
+  trains[4].Steps.resize(1);
+  trains[4].Steps[0].SpawnMinuteUTC = -2147483647 - 1;
+  trains[4].Steps[0].DurationMinutes = 2147483647;
+  return trains;
+}
+
+static bool RoundTrips(
+    const char *backend,
+    const std::function<std::string(const TrainTemplate &)> &encode,
+    const std::function<bool(const std::string &, TrainTemplate &)> &decode) {
+  auto samples = Samples();
+  for (size_t i = 0; i < samples.size(); ++i) {
+    TrainTemplate decoded;
+    if (!decode(encode(samples[i]), decoded) || decoded != samples[i]) {
+      printf("  %s lost data in sample %zu\n", backend, i);
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool FormatRoundTrips(TrainFormat format) {
+  return RoundTrips(
+      TrainCodec::FormatName(format),
+      [format](const TrainTemplate &t) { return TrainCodec::Encode(t, format); },
+      [format](const std::string &data, TrainTemplate &out) {
+        return TrainCodec::Decode(data, format, out);
+      });
+}
+
+static bool ShareDecode(const std::string &text, TrainTemplate &out) {
+  return TrainCodec::FromShareString(text, out);
+}
+
+TC_TEST(TrainCodec_JsonDomRoundTrip) {
+  CHECK(RoundTrips(
+      "pretty JSON (DOM)",
+      [](const TrainTemplate &t) { return TrainCodec::ToJsonText(t, true); },
+      [](const std::string &text, TrainTemplate &out) {
+        try {
+          TrainCodec::FromJson(TrainCodec::json::parse(text), out);
+          return true;
+        } catch (...) {
+          return false;
+        }
+      }));
+}
+
+TC_TEST(TrainCodec_StorageFormatsRoundTrip) {
+  CHECK(FormatRoundTrips(TrainFormat::PrettyJson));
+  CHECK(FormatRoundTrips(TrainFormat::CompactJson));
+  CHECK(FormatRoundTrips(TrainFormat::Cbor));
+  CHECK(FormatRoundTrips(TrainFormat::MsgPack));
+}
+
+TC_TEST(TrainCodec_BinaryRoundTrip) {
+  CHECK(RoundTrips("binary", TrainCodec::ToBinary, TrainCodec::FromBinary));
+}
+
+TC_TEST(TrainCodec_ShareStringRoundTrip) {
+  CHECK(RoundTrips("share string", TrainCodec::ToShareString, ShareDecode));
+  // Strings shared by earlier versions still import
+  CHECK(RoundTrips(
+      "share string (legacy)",
+      [](const TrainTemplate &t) {
+        return Base64::Encode(TrainCodec::ToJsonText(t, false));
+      },
+      ShareDecode));
+}
+
+TC_TEST(TrainCodec_RejectsDamagedInput) {
+  TrainTemplate train = Samples()[0];
+  std::string cbor = TrainCodec::Encode(train, TrainFormat::Cbor);
+  TrainTemplate out;
+  CHECK(!TrainCodec::Decode(cbor.substr(0, cbor.size() / 2), TrainFormat::Cbor,
+                            out));
+  std::string share = TrainCodec::ToShareString(train);
+  std::string error;
+  CHECK(!TrainCodec::FromShareString(share.substr(0, share.size() - 8), out,
+                                     &error));
+  CHECK(!error.empty());
+}
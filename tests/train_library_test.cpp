@@ -0,0 +1,327 @@
+#include "test_util.h"
+
+#include "platform.h"
+#include "train_manager.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <thread>
+
+static std::vector<TrainTemplate> MakeTrains(int count) {
+  std::vector<TrainTemplate> trains;
+  for (int t = 0; t < count; ++t) {
+    TrainTemplate train;
+    train.Name = "Train " + std::to_string(t);
+    train.Author = "Author";
+    train.Type = static_cast<TrainType>(t % 3);
+    for (int s = 0; s <= t % 4; ++s) {
+      TrainStep step;
+      step.Title = "Step " + std::to_string(s);
+      step.WaypointCode = "[&BAAAAAA=]";
+      step.SquadMessage = "Next up: {title} {wp} ({eta})";
+      step.Mechanics = "Group 1 left\nGroup 2 right";
+      step.SpawnMinuteUTC = (t * 60 + s * 15) % 1440;
+      step.DurationMinutes = 15;
+      step.CustomMessages.push_back({"Ready", "Stack on the tag \xE2\x9C\x93"});
+      Callout callout;
+      callout.OffsetSeconds = -120;
+      callout.Content = CalloutContent::CustomMessage;
+      step.Callouts.push_back(callout);
+      train.Steps.push_back(step);
+    }
+    trains.push_back(train);
+  }
+  return trains;
+}
+
+// Loads `dir` into a fresh manager and compares every train, body included
+static bool LibraryEquals(const std::string &dir,
+                          const std::vector<TrainTemplate> &expected) {
+  TrainManager loader(dir);
+  loader.LoadTrains();
+  auto &trains = loader.GetTrains();
+  if (trains.size() != expected.size())
+    return false;
+  for (int i = 0; i < static_cast<int>(trains.size()); ++i) {
+    if (!loader.EnsureLoaded(i) || trains[i] != expected[i])
+      return false;
+  }
+  return true;
+}
+
+TC_TEST(TrainLibrary_SaveLoadRoundTrip) {
+  std::string dir = TestUtil::FreshDirectory("library_round_trip");
+  auto trains = MakeTrains(20);
+  {
+    TrainManager manager(dir);
+    manager.GetTrains() = trains;
+    manager.SaveTrains();
+    CHECK(!manager.IsDirty());
+  }
+  CHECK(LibraryEquals(dir, trains));
+
+  // Header-only until a body is asked for
+  TrainManager loader(dir);
+  loader.LoadTrains();
+  CHECK(loader.GetTrains().size() == trains.size());
+  CHECK(!loader.GetTrains()[3].StepsLoaded);
+  CHECK(loader.GetTrains()[3].Name == "Train 3");
+}
+
+TC_TEST(TrainLibrary_JournaledEditsSurviveReload) {
+  std::string dir = TestUtil::FreshDirectory("library_journal");
+  auto expected = MakeTrains(12);
+  {
+    TrainManager manager(dir);
+    manager.GetTrains() = expected;
+    manager.SaveTrains();
+  }
+  {
+    TrainManager manager(dir);
+    manager.LoadTrains();
+    auto &trains = manager.GetTrains();
+    manager.EnsureLoaded(5);
+    trains[5].Steps[0].Title = "Edited";
+    trains[2].Name = "Renamed";
+    trains.erase(trains.begin() + 7);
+    manager.MarkDirty();
+    manager.SaveTrains();
+  }
+  expected[5].Steps[0].Title = "Edited";
+  expected[2].Name = "Renamed";
+  expected.erase(expected.begin() + 7);
+  CHECK(LibraryEquals(dir, expected));
+}
+
+TC_TEST(TrainLibrary_StorageFormatSwitchRewritesShards) {
+  std::string dir = TestUtil::FreshDirectory("library_format");
+  auto trains = MakeTrains(10);
+  {
+    TrainManager manager(dir);
+    manager.GetTrains() = trains;
+    manager.SaveTrains();
+  }
+  for (TrainFormat format : {TrainFormat::Cbor, TrainFormat::MsgPack,
+                             TrainFormat::PrettyJson}) {
+    {
+      // Bodies stay on disk; the conversion has to read them back
+      TrainManager manager(dir);
+      manager.LoadTrains();
+      manager.SetStorageFormat(format);
+      manager.SaveTrains();
+    }
+    TrainManager loader(dir);
+    loader.LoadTrains();
+    CHECK(loader.GetStorageFormat() == format);
+    CHECK(LibraryEquals(dir, trains));
+  }
+}
+
+static size_t CountShards(const std::string &dir) {
+  size_t shards = 0;
+  for (const auto &name : Platform::ListDirectory(dir + "/trains")) {
+    if (name.find('-') != std::string::npos)
+      shards++;
+  }
+  return shards;
+}
+
+static bool SameNames(std::vector<TrainTemplate> trains,
+                      std::vector<TrainTemplate> expected) {
+  auto byName = [](const TrainTemplate &a, const TrainTemplate &b) {
+    return a.Name < b.Name;
+  };
+  std::sort(trains.begin(), trains.end(), byName);
+  std::sort(expected.begin(), expected.end(), byName);
+  if (trains.size() != expected.size())
+    return false;
+  for (size_t i = 0; i < trains.size(); ++i) {
+    if (trains[i].Name != expected[i].Name)
+      return false;
+  }
+  return true;
+}
+
+TC_TEST(TrainLibrary_DamagedIndexIsRebuiltFromShards) {
+  std::string dir = TestUtil::FreshDirectory("library_damaged_index");
+  auto trains = MakeTrains(3);
+  {
+    TrainManager manager(dir);
+    manager.GetTrains() = trains;
+    manager.SaveTrains();
+  }
+  CHECK(CountShards(dir) == 3);
+  Platform::WriteFileAtomic(dir + "/trains/index.json", "");
+
+  {
+    TrainManager manager(dir);
+    manager.LoadTrains();
+    CHECK(!manager.IsReadOnly());
+    CHECK(manager.IsDirty()); // The rebuilt index still has to be written
+    CHECK(SameNames(manager.GetTrains(), trains));
+    CHECK(manager.SaveTrains());
+  }
+  CHECK(CountShards(dir) == 3);
+  CHECK(Platform::FileExists(dir + "/trains/index.json.corrupt"));
+
+  TrainManager loader(dir);
+  loader.LoadTrains();
+  auto &loaded = loader.GetTrains();
+  CHECK(SameNames(loaded, trains));
+  for (int i = 0; i < static_cast<int>(loaded.size()); ++i) {
+    CHECK(loader.EnsureLoaded(i));
+    bool found = false;
+    for (const auto &train : trains)
+      found = found || train == loaded[i];
+    CHECK(found);
+  }
+}
+
+TC_TEST(TrainLibrary_UnreadableIndexBlocksSaving) {
+  std::string dir = TestUtil::FreshDirectory("library_unreadable_index");
+  {
+    TrainManager manager(dir);
+    manager.GetTrains() = MakeTrains(3);
+    manager.SaveTrains();
+  }
+  // A directory in its place exists but cannot be mapped, like a file
+  // another process holds locked
+  std::string indexPath = dir + "/trains/index.json";
+  Platform::RemoveFile(indexPath);
+  std::filesystem::create_directory(indexPath);
+
+  TrainManager manager(dir);
+  manager.LoadTrains();
+  CHECK(manager.IsReadOnly());
+  CHECK(manager.GetTrains().empty());
+  CHECK(!manager.SaveTrains());
+  CHECK(CountShards(dir) == 3);
+}
+
+TC_TEST(TrainLibrary_UnreadableShardKeepsTrainHeaderOnly) {
+  std::string dir = TestUtil::FreshDirectory("library_unreadable_shard");
+  auto expected = MakeTrains(3);
+  {
+    TrainManager manager(dir);
+    manager.GetTrains() = expected;
+    manager.SaveTrains();
+  }
+
+  std::string shardPath;
+  {
+    TrainManager manager(dir);
+    manager.LoadTrains();
+    std::string id = manager.GetTrains()[1].Id;
+    for (const auto &name : Platform::ListDirectory(dir + "/trains")) {
+      if (name.compare(0, id.size(), id) == 0)
+        shardPath = dir + "/trains/" + name;
+    }
+    // Swap the shard for a directory: present, but it cannot be mapped
+    std::filesystem::rename(shardPath, shardPath + ".away");
+    std::filesystem::create_directories(shardPath + "/busy");
+
+    CHECK(!manager.EnsureLoaded(1));
+    CHECK(!manager.GetTrains()[1].StepsLoaded);
+    CHECK(!manager.SetActiveTrain(1));
+    CHECK(manager.GetActiveTrain() == nullptr);
+    manager.GetTrains()[1].Name = "Renamed";
+    manager.MarkDirty();
+    CHECK(manager.SaveTrains());
+  }
+  std::filesystem::remove_all(shardPath);
+  std::filesystem::rename(shardPath + ".away", shardPath);
+
+  expected[1].Name = "Renamed";
+  CHECK(LibraryEquals(dir, expected));
+}
+
+TC_TEST(TrainLibrary_DeletedTrainsDoNotCountAsResident) {
+  std::string dir = TestUtil::FreshDirectory("library_lru");
+  {
+    TrainManager manager(dir);
+    manager.GetTrains() = MakeTrains(12);
+    manager.SaveTrains();
+  }
+  TrainManager manager(dir);
+  manager.LoadTrains();
+  auto &trains = manager.GetTrains();
+  for (int i = 0; i < 8; ++i)
+    manager.EnsureLoaded(i);
+  // The trains about to be deleted become the most recently used
+  for (int i = 0; i < 4; ++i)
+    manager.EnsureLoaded(i);
+  trains.erase(trains.begin(), trains.begin() + 4);
+  manager.MarkDirty();
+  manager.SaveTrains();
+
+  for (int i = 4; i < 8; ++i)
+    manager.EnsureLoaded(i);
+  size_t resident = 0;
+  for (const auto &train : trains)
+    resident += train.StepsLoaded ? 1 : 0;
+  CHECK(resident == TrainManager::kMaxResidentTrains);
+}
+
+TC_TEST(TrainLibrary_FormatSwitchAbortsOnUnreadableShard) {
+  std::string dir = TestUtil::FreshDirectory("library_format_unreadable");
+  auto expected = MakeTrains(3);
+  {
+    TrainManager manager(dir);
+    manager.GetTrains() = expected;
+    manager.SaveTrains();
+  }
+
+  TrainManager manager(dir);
+  manager.LoadTrains();
+  std::string id = manager.GetTrains()[2].Id;
+  std::string shardPath;
+  for (const auto &name : Platform::ListDirectory(dir + "/trains")) {
+    if (name.compare(0, id.size(), id) == 0)
+      shardPath = dir + "/trains/" + name;
+  }
+  std::filesystem::rename(shardPath, shardPath + ".away");
+  std::filesystem::create_directories(shardPath + "/busy");
+
+  manager.SetStorageFormat(TrainFormat::Cbor);
+  CHECK(!manager.SaveTrains());
+  CHECK(manager.IsDirty());
+
+  // Once the shard is readable again the conversion goes through
+  std::filesystem::remove_all(shardPath);
+  std::filesystem::rename(shardPath + ".away", shardPath);
+  CHECK(manager.SaveTrains());
+  CHECK(!Platform::FileExists(shardPath)); // Replaced by its CBOR shard
+  CHECK(LibraryEquals(dir, expected));
+}
+
+TC_TEST(TrainLibrary_FailedAutosaveStaysDirtyAndRetries) {
+  std::string dir = TestUtil::FreshDirectory("library_autosave_retry");
+  // A file where the library directory belongs makes every write fail
+  std::string blocker = dir + "/trains";
+  Platform::WriteFileAtomic(blocker, "");
+
+  auto trains = MakeTrains(2);
+  TrainManager manager(dir);
+  manager.GetTrains() = trains;
+  manager.MarkDirty();
+  manager.RequestSave();
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (!manager.LastWriteFailed() &&
+         std::chrono::steady_clock::now() < deadline)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  CHECK(manager.LastWriteFailed());
+  CHECK(manager.IsDirty());
+
+  // No further edit; Update alone has to get it onto the disk
+  Platform::RemoveFile(blocker);
+  deadline = std::chrono::steady_clock::now() + TrainManager::kAutosaveDelay +
+             std::chrono::seconds(5);
+  while (manager.IsDirty() && std::chrono::steady_clock::now() < deadline) {
+    manager.Update();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  }
+  CHECK(!manager.IsDirty());
+  CHECK(!manager.LastWriteFailed());
+  CHECK(LibraryEquals(dir, trains));
+}